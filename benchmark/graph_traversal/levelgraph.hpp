@@ -274,6 +274,10 @@ std::chrono::microseconds measure_time_taskflow(LevelGraph&, unsigned);
 std::chrono::microseconds measure_time_omp(LevelGraph&, unsigned);
 std::chrono::microseconds measure_time_tbb(LevelGraph&, unsigned);
 
+// construction time, traversal time, and resident memory (MB) of the taskflow graph
+std::tuple<std::chrono::microseconds, std::chrono::microseconds, double> 
+measure_phases_taskflow(LevelGraph&, unsigned);
+
 
 
 #endif
@@ -45,6 +45,37 @@ int main(int argc, char* argv[]) {
               << std::setw(12) << tbb_time / tf_time
               << std::endl;
   }
+
+  // construction and traversal of the taskflow graph alone
+  std::cout << '\n'
+            << std::setw(12) << "|V|+|E|"
+            << std::setw(12) << "build(ms)"
+            << std::setw(12) << "run(ms)"
+            << std::setw(12) << "rss(MB)"
+            << '\n';
+
+  for(int i=1; i<=1501; i += 250) {
+
+    double build_time {0.0};
+    double run_time {0.0};
+    double mem {0.0};
+
+    LevelGraph graph(i, i);
+
+    for(int j=0; j<rounds; ++j) {
+      auto [b, r, m] = measure_phases_taskflow(graph, num_threads);
+      build_time += b.count();
+      run_time += r.count();
+      mem += m;
+      graph.clear_graph();
+    }
+
+    std::cout << std::setw(12) << graph.graph_size()
+              << std::setw(12) << build_time / rounds / 1e3
+              << std::setw(12) << run_time / rounds / 1e3
+              << std::setw(12) << mem / rounds
+              << std::endl;
+  }
 }
 
 
@@ -1,5 +1,7 @@
 #include <iostream>
 #include <chrono>
+#include <fstream>
+#include <unistd.h>
 
 #include <taskflow/taskflow.hpp>
 #include "levelgraph.hpp"
@@ -50,3 +52,28 @@ std::chrono::microseconds measure_time_taskflow(LevelGraph& graph, unsigned num_
   return std::chrono::duration_cast<std::chrono::microseconds>(end - beg);
 }
 
+
+// Function: rss
+// Resident set size of this process in megabytes (Linux only).
+static double rss() {
+  std::ifstream ifs("/proc/self/statm");
+  size_t pages {0}, resident {0};
+  ifs >> pages >> resident;
+  return resident * static_cast<double>(::sysconf(_SC_PAGESIZE)) / (1 << 20);
+}
+
+std::tuple<std::chrono::microseconds, std::chrono::microseconds, double> 
+measure_phases_taskflow(LevelGraph& graph, unsigned num_threads) {
+  auto mem = rss();
+  auto beg = std::chrono::high_resolution_clock::now();
+  TF tf(graph, num_threads);
+  auto mid = std::chrono::high_resolution_clock::now();
+  mem = rss() - mem;
+  tf.run();
+  auto end = std::chrono::high_resolution_clock::now();
+  return {
+    std::chrono::duration_cast<std::chrono::microseconds>(mid - beg),
+    std::chrono::duration_cast<std::chrono::microseconds>(end - mid),
+    mem
+  };
+}
@@ -0,0 +1,159 @@
+// Compares the flat stealing strategy (crossing locality domains on every
+// failed round) against the hierarchical strategy (staying in the thief's
+// own domain for a number of rounds) on the wavefront and graph traversal
+// workloads.
+
+#include "../wavefront/matrix.hpp"
+#include "../graph_traversal/levelgraph.hpp"
+
+using Executor = tf::Taskflow::Executor;
+
+struct Result {
+  double time {0.0};
+  size_t steals {0};
+  size_t cross_domain_steals {0};
+};
+
+// wavefront computing
+Result wavefront(unsigned num_threads, unsigned rounds) {
+
+  auto executor = std::make_shared<Executor>(num_threads);
+  executor->cross_domain_rounds(rounds);
+
+  tf::Taskflow tf(executor);
+
+  std::vector<std::vector<tf::Task>> node(MB);
+
+  for(auto &n : node){
+    for(int i=0; i<NB; i++){
+      n.emplace_back(tf.placeholder());
+    }
+  }
+  
+  matrix[M-1][N-1] = 0;
+  for( int i=MB; --i>=0; ) {
+    for( int j=NB; --j>=0; ) {
+      node[i][j].work([=]() { block_computation(i, j); });
+      if(j+1 < NB) node[i][j].precede(node[i][j+1]);
+      if(i+1 < MB) node[i][j].precede(node[i+1][j]);
+    }
+  }
+  
+  auto beg = std::chrono::high_resolution_clock::now();
+  tf.wait_for_all();
+  auto end = std::chrono::high_resolution_clock::now();
+
+  return {
+    std::chrono::duration<double, std::milli>(end - beg).count(),
+    executor->num_steals(),
+    executor->num_cross_domain_steals()
+  };
+}
+
+// graph traversal
+Result traversal(LevelGraph& graph, unsigned num_threads, unsigned rounds) {
+
+  auto executor = std::make_shared<Executor>(num_threads);
+  executor->cross_domain_rounds(rounds);
+
+  tf::Taskflow tf(executor);
+
+  std::vector<std::vector<tf::Task>> tasks(graph.level());
+
+  for(size_t i=0; i<tasks.size(); ++i) {
+    tasks[i].resize(graph.length());
+  }
+
+  for(size_t i=0; i<graph.length(); i++){
+    Node& n = graph.node_at(graph.level()-1, i); 
+    tasks[graph.level()-1][i] = tf.emplace([&](){ n.mark(); });
+  }
+
+  for(int l=graph.level()-2; l>=0 ; l--){
+    for(size_t i=0; i<graph.length(); i++){
+      Node& n = graph.node_at(l, i);
+      tasks[l][i] = tf.emplace([&](){ n.mark();});
+      for(size_t k=0; k<n._out_edges.size(); k++){
+        tasks[l][i].precede(tasks[l+1][n._out_edges[k]]);
+      } 
+    }
+  }
+  
+  auto beg = std::chrono::high_resolution_clock::now();
+  tf.wait_for_all();
+  auto end = std::chrono::high_resolution_clock::now();
+
+  return {
+    std::chrono::duration<double, std::milli>(end - beg).count(),
+    executor->num_steals(),
+    executor->num_cross_domain_steals()
+  };
+}
+
+// Procedure: report
+void report(const std::string& label, size_t size, const Result& flat, const Result& hier) {
+  std::cout << std::setw(12) << label
+            << std::setw(12) << size
+            << std::setw(12) << flat.time
+            << std::setw(12) << hier.time
+            << std::setw(24) << (std::to_string(flat.cross_domain_steals) + '/' + 
+                                 std::to_string(flat.steals))
+            << std::setw(24) << (std::to_string(hier.cross_domain_steals) + '/' + 
+                                 std::to_string(hier.steals))
+            << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+
+  unsigned num_threads = std::thread::hardware_concurrency();
+  unsigned rounds = 4;
+
+  if(argc > 1) {
+    num_threads = std::atoi(argv[1]);
+  }
+
+  if(argc > 2) {
+    rounds = std::atoi(argv[2]);
+  }
+
+  std::cout << "workers: " << num_threads 
+            << ", domains: " << tf::CpuTopology::system().num_domains()
+            << ", cross-domain rounds: " << rounds << '\n';
+
+  std::cout << std::setw(12) << "workload"
+            << std::setw(12) << "size"
+            << std::setw(12) << "flat(ms)"
+            << std::setw(12) << "hier(ms)"
+            << std::setw(24) << "flat cross/all"
+            << std::setw(24) << "hier cross/all"
+            << '\n';
+
+  for(int S=32; S<=4096; S += 512) {
+
+    M = N = S;
+    B = 8;
+    MB = (M/B) + (M%B>0);
+    NB = (N/B) + (N%B>0);
+
+    init_matrix();
+    auto flat = wavefront(num_threads, 0);
+    auto hier = wavefront(num_threads, rounds);
+    destroy_matrix();
+
+    report("wavefront", MB*NB, flat, hier);
+  }
+
+  for(int i=1; i<=451; i += 50) {
+
+    LevelGraph graph(i, i);
+
+    auto flat = traversal(graph, num_threads, 0);
+    graph.clear_graph();
+    auto hier = traversal(graph, num_threads, rounds);
+    graph.clear_graph();
+
+    report("traversal", graph.graph_size(), flat, hier);
+  }
+
+  return 0;
+}
@@ -0,0 +1,100 @@
+// Measures the per-task overhead of building and running task graphs
+// whose tasks do no work: linear chains, where every task releases exactly
+// one successor, and level graphs, where each task releases a few random
+// tasks of the next level. Both are dominated by the scheduler touching
+// the join counters and successor lists of the nodes.
+
+#include <taskflow/taskflow.hpp>
+#include <random>
+
+// Function: elapsed
+// Nanoseconds per task between two time points.
+template <typename T>
+double elapsed(T beg, T end, size_t num_tasks) {
+  return std::chrono::duration<double, std::nano>(end - beg).count() / num_tasks;
+}
+
+// Procedure: build_chain
+void build_chain(tf::Framework& f, size_t length) {
+  auto prev = f.emplace([](){});
+  for(size_t i=1; i<length; ++i) {
+    auto curr = f.emplace([](){});
+    prev.precede(curr);
+    prev = curr;
+  }
+}
+
+// Procedure: build_level_graph
+// Each task of a level precedes one to four random tasks of the next level.
+void build_level_graph(tf::Framework& f, size_t length, size_t levels) {
+
+  std::mt19937 g(0);
+  std::uniform_int_distribution<size_t> fanout(1, 4);
+  std::uniform_int_distribution<size_t> target(0, length-1);
+
+  std::vector<tf::Task> prev, curr;
+
+  for(size_t l=0; l<levels; ++l) {
+    curr.clear();
+    for(size_t i=0; i<length; ++i) {
+      curr.push_back(f.emplace([](){}));
+    }
+    for(auto& t : prev) {
+      for(size_t k=fanout(g); k>0; --k) {
+        t.precede(curr[target(g)]);
+      }
+    }
+    std::swap(prev, curr);
+  }
+}
+
+// Procedure: measure
+template <typename B>
+void measure(const std::string& name, size_t num_tasks, unsigned num_threads, B&& build) {
+
+  tf::Taskflow tf(num_threads);
+  tf::Framework f;
+
+  auto beg = std::chrono::high_resolution_clock::now();
+  build(f);
+  auto mid = std::chrono::high_resolution_clock::now();
+  tf.run_n(f, 10).get();
+  auto end = std::chrono::high_resolution_clock::now();
+
+  std::cout << std::setw(12) << name
+            << std::setw(10) << num_threads
+            << std::setw(12) << num_tasks
+            << std::setw(16) << elapsed(beg, mid, num_tasks)
+            << std::setw(16) << elapsed(mid, end, num_tasks * 10)
+            << std::endl;
+}
+
+// ----------------------------------------------------------------------------
+
+int main(int argc, char* argv[]) {
+
+  unsigned max_threads = argc > 1 ? std::stoul(argv[1]) :
+                         std::max(1u, std::thread::hardware_concurrency());
+
+  std::cout << "sizeof(tf::Node) = " << sizeof(tf::Node)
+            << ", alignof(tf::Node) = " << alignof(tf::Node) << '\n';
+
+  std::cout << std::setw(12) << "graph"
+            << std::setw(10) << "threads"
+            << std::setw(12) << "tasks"
+            << std::setw(16) << "build(ns/task)"
+            << std::setw(16) << "run(ns/task)"
+            << std::endl;
+
+  for(unsigned W=1; W<=max_threads; W*=2) {
+    for(size_t n : {10000, 100000, 1000000}) {
+      measure("chain", n, W, [n] (tf::Framework& f) { build_chain(f, n); });
+    }
+    for(size_t n : {100, 300, 1000}) {
+      measure("level", n*n, W, [n] (tf::Framework& f) { build_level_graph(f, n, n); });
+    }
+  }
+
+  return 0;
+}
+
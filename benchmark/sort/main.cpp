@@ -0,0 +1,106 @@
+// Compares tf::FlowBuilder::sort against std::sort and tbb::parallel_sort
+// on random integers. The taskflow sort is measured twice: with its own
+// scratch buffer, allocated on each run, and with a scratch buffer supplied
+// by the caller, which makes the steady state free of allocations.
+
+#include <taskflow/taskflow.hpp>
+#include <random>
+
+#include <tbb/task_scheduler_init.h>
+#include <tbb/parallel_sort.h>
+
+// Function: random_data
+std::vector<int> random_data(size_t N) {
+  std::mt19937 g(0);
+  std::uniform_int_distribution<int> dist;
+  std::vector<int> data(N);
+  for(auto& d : data) {
+    d = dist(g);
+  }
+  return data;
+}
+
+// Function: measure
+// Milliseconds per sort, copying the unsorted input over the data before
+// each sort.
+template <typename S>
+double measure(const std::vector<int>& input, std::vector<int>& data, unsigned rounds, S&& sort) {
+  double total {0.0};
+  for(unsigned r=0; r<rounds; ++r) {
+    data = input;
+    auto beg = std::chrono::high_resolution_clock::now();
+    sort();
+    auto end = std::chrono::high_resolution_clock::now();
+    total += std::chrono::duration<double, std::milli>(end - beg).count();
+    if(!std::is_sorted(data.begin(), data.end())) {
+      std::cerr << "unsorted output\n";
+      std::exit(EXIT_FAILURE);
+    }
+  }
+  return total / rounds;
+}
+
+// ----------------------------------------------------------------------------
+
+int main(int argc, char* argv[]) {
+
+  unsigned num_threads = argc > 1 ? std::stoul(argv[1]) :
+                         std::max(1u, std::thread::hardware_concurrency());
+
+  const unsigned rounds {5};
+  const int width {12};
+
+  std::cout << std::setw(width) << "N"
+            << std::setw(width) << "std(ms)"
+            << std::setw(width) << "TBB(ms)"
+            << std::setw(width) << "TF(ms)"
+            << std::setw(width) << "TF+buf(ms)"
+            << std::setw(width) << "speedup1"
+            << std::setw(width) << "speedup2"
+            << std::endl;
+
+  std::cout.precision(3);
+
+  tbb::task_scheduler_init init(num_threads);
+  tf::Taskflow tf(num_threads);
+
+  for(size_t N : {10000, 100000, 1000000, 10000000}) {
+
+    const auto input = random_data(N);
+    std::vector<int> data(N);
+    std::vector<int> scratch(N);
+
+    // the data keep their storage when the input is copied over them
+    tf::Framework f1, f2;
+    f1.sort(data.begin(), data.end());
+    f2.sort(data.begin(), data.end(), scratch.begin(), std::less<int>());
+
+    double seq_time = measure(input, data, rounds, [&] () {
+      std::sort(data.begin(), data.end());
+    });
+
+    double tbb_time = measure(input, data, rounds, [&] () {
+      tbb::parallel_sort(data.begin(), data.end());
+    });
+
+    double tf_time = measure(input, data, rounds, [&] () {
+      tf.run(f1).get();
+    });
+
+    double tf_buf_time = measure(input, data, rounds, [&] () {
+      tf.run(f2).get();
+    });
+
+    std::cout << std::setw(width) << N << std::fixed
+              << std::setw(width) << seq_time
+              << std::setw(width) << tbb_time
+              << std::setw(width) << tf_time
+              << std::setw(width) << tf_buf_time
+              << std::setw(width) << seq_time / tf_buf_time
+              << std::setw(width) << tbb_time / tf_buf_time
+              << std::endl;
+  }
+
+  return 0;
+}
+
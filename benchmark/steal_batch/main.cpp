@@ -0,0 +1,137 @@
+// Compares single-item stealing against batch stealing (a thief takes up 
+// to half of a victim's closures in one steal) on workloads where one 
+// worker ends up with a large backlog: the level graph traversal and 
+// a wide fan-out from a single task.
+
+#include "../graph_traversal/levelgraph.hpp"
+
+using Executor = tf::Taskflow::Executor;
+
+struct Result {
+  double time {0.0};
+  size_t steals {0};
+};
+
+// graph traversal
+Result traversal(LevelGraph& graph, unsigned num_threads, size_t batch) {
+
+  auto executor = std::make_shared<Executor>(num_threads);
+  executor->max_steal_batch(batch);
+
+  tf::Taskflow tf(executor);
+
+  std::vector<std::vector<tf::Task>> tasks(graph.level());
+
+  for(size_t i=0; i<tasks.size(); ++i) {
+    tasks[i].resize(graph.length());
+  }
+
+  for(size_t i=0; i<graph.length(); i++){
+    Node& n = graph.node_at(graph.level()-1, i); 
+    tasks[graph.level()-1][i] = tf.emplace([&](){ n.mark(); });
+  }
+
+  for(int l=graph.level()-2; l>=0 ; l--){
+    for(size_t i=0; i<graph.length(); i++){
+      Node& n = graph.node_at(l, i);
+      tasks[l][i] = tf.emplace([&](){ n.mark();});
+      for(size_t k=0; k<n._out_edges.size(); k++){
+        tasks[l][i].precede(tasks[l+1][n._out_edges[k]]);
+      } 
+    }
+  }
+  
+  auto beg = std::chrono::high_resolution_clock::now();
+  tf.wait_for_all();
+  auto end = std::chrono::high_resolution_clock::now();
+
+  return {
+    std::chrono::duration<double, std::milli>(end - beg).count(),
+    executor->num_steals()
+  };
+}
+
+// one task releasing a large number of successors at once
+Result fanout(size_t width, unsigned num_threads, size_t batch) {
+
+  auto executor = std::make_shared<Executor>(num_threads);
+  executor->max_steal_batch(batch);
+
+  tf::Taskflow tf(executor);
+
+  std::atomic<size_t> sum {0};
+
+  auto S = tf.emplace([](){});
+
+  for(size_t i=0; i<width; ++i) {
+    S.precede(tf.emplace([&, i] () { 
+      size_t x = i;
+      for(int k=0; k<100; ++k) {
+        x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+      }
+      sum.fetch_add(x & 1, std::memory_order_relaxed);
+    }));
+  }
+
+  auto beg = std::chrono::high_resolution_clock::now();
+  tf.wait_for_all();
+  auto end = std::chrono::high_resolution_clock::now();
+
+  return {
+    std::chrono::duration<double, std::milli>(end - beg).count(),
+    executor->num_steals()
+  };
+}
+
+// Procedure: report
+void report(const std::string& label, size_t size, const Result& single, const Result& batch) {
+  std::cout << std::setw(12) << label
+            << std::setw(12) << size
+            << std::setw(14) << single.time
+            << std::setw(14) << batch.time
+            << std::setw(14) << single.steals
+            << std::setw(14) << batch.steals
+            << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+
+  unsigned num_threads = std::thread::hardware_concurrency();
+  size_t batch = 32;
+
+  if(argc > 1) {
+    num_threads = std::atoi(argv[1]);
+  }
+
+  if(argc > 2) {
+    batch = std::atoi(argv[2]);
+  }
+
+  std::cout << "workers: " << num_threads << ", max steal batch: " << batch << '\n';
+
+  std::cout << std::setw(12) << "workload"
+            << std::setw(12) << "size"
+            << std::setw(14) << "single(ms)"
+            << std::setw(14) << "batch(ms)"
+            << std::setw(14) << "single steals"
+            << std::setw(14) << "batch steals"
+            << '\n';
+
+  for(int i=1; i<=451; i += 50) {
+
+    LevelGraph graph(i, i);
+
+    auto single = traversal(graph, num_threads, 1);
+    graph.clear_graph();
+    auto batched = traversal(graph, num_threads, batch);
+    graph.clear_graph();
+
+    report("traversal", graph.graph_size(), single, batched);
+  }
+
+  for(size_t w=1000; w<=1000000; w *= 10) {
+    report("fanout", w, fanout(w, num_threads, 1), fanout(w, num_threads, batch));
+  }
+
+  return 0;
+}
@@ -0,0 +1,100 @@
+// Measures the resident memory of the work-stealing executor after bursts
+// of ready tasks. Each burst pushes a large number of closures into a 
+// worker queue, forcing it to grow; once the burst drains and the workers 
+// go idle, retired arrays are reclaimed and the queues shrink back.
+
+#include <taskflow/taskflow.hpp>
+#include <unistd.h>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+// Function: rss
+// Resident set size of this process in megabytes (Linux only).
+double rss() {
+  std::ifstream ifs("/proc/self/statm");
+  size_t pages {0}, resident {0};
+  ifs >> pages >> resident;
+  return resident * static_cast<double>(::sysconf(_SC_PAGESIZE)) / (1 << 20);
+}
+
+// Procedure: queue_bursts
+// Pushes a burst into a single queue, drains it, and shrinks it.
+void queue_bursts(size_t burst, unsigned rounds) {
+  
+  tf::WorkStealingQueue<std::function<void()>> queue;
+
+  std::cout << "[queue] burst=" << burst << '\n';
+  
+  for(unsigned r=0; r<rounds; ++r) {
+    for(size_t i=0; i<burst; ++i) {
+      queue.push([](){});
+    }
+    auto full = rss();
+    while(queue.pop());
+    queue.shrink();
+    std::cout << "  round " << r 
+              << ": rss(full)=" << full << "MB"
+              << " rss(drained)=" << rss() << "MB"
+              << " capacity=" << queue.capacity() << '\n';
+  }
+}
+
+// Procedure: executor_bursts
+// Lets one worker spawn a burst of closures and waits for the pool to idle.
+void executor_bursts(unsigned num_threads, size_t burst, unsigned rounds) {
+
+  using namespace std::literals::chrono_literals;
+
+  tf::WorkStealingThreadpool<std::function<void()>> pool(num_threads);
+  
+  std::cout << "[executor] threads=" << num_threads << " burst=" << burst << '\n';
+
+  for(unsigned r=0; r<rounds; ++r) {
+
+    std::atomic<size_t> counter {0};
+
+    auto beg = std::chrono::high_resolution_clock::now();
+
+    pool.emplace([&] () {
+      for(size_t i=0; i<burst; ++i) {
+        pool.emplace([&] () { counter.fetch_add(1, std::memory_order_relaxed); });
+      }
+    });
+
+    while(counter != burst) {
+      std::this_thread::yield();
+    }
+    
+    auto end = std::chrono::high_resolution_clock::now();
+
+    // give the workers time to go idle
+    std::this_thread::sleep_for(100ms);
+
+    std::cout << "  round " << r 
+              << ": time=" << std::chrono::duration<double, std::milli>(end - beg).count() << "ms"
+              << " rss(idle)=" << rss() << "MB\n";
+  }
+}
+
+int main(int argc, char* argv[]) {
+
+  size_t burst = (argc > 1) ? std::stoul(argv[1]) : 1000000;
+  unsigned rounds = (argc > 2) ? std::stoul(argv[2]) : 5;
+  unsigned num_threads = (argc > 3) ? std::stoul(argv[3]) : std::thread::hardware_concurrency();
+
+  // Keep large arrays on mmap so that freeing them shows up in the RSS;
+  // glibc otherwise raises the threshold after the first free and serves
+  // later arrays from arenas it may not return to the system.
+#if defined(__GLIBC__)
+  ::mallopt(M_MMAP_THRESHOLD, 128 * 1024);
+#endif
+
+  std::cout << "rss(start)=" << rss() << "MB\n";
+
+  queue_bursts(burst, rounds);
+  executor_bursts(num_threads, burst, rounds);
+
+  return 0;
+}
@@ -5,20 +5,13 @@
 cpp-taskflow works on directed acyclic graphs.
 And here we want to pass information between the flow elements.
 
-To do so, we see the cpp-taskflow arcs as objects memory where the functions on
-the nodes read from or write to.
-
-The function on every node will *read from* the objects of memory of its
-incoming edges and *write to* the objects of its outcoming edges.
+To do so, we create the tasks with tf::FlowBuilder::dataflow: the value a
+task returns is kept by the task and passed as an argument to the tasks that
+take it as an input. A value taken by one task is moved into it.
 
 The cpp-taskflow semantics ensures the synchronization.
 
 
-Nodes without incoming edges will require the input from somewhere else;
-instead nodes without outcoming edges have to execute some side effects to be
-useful.
-
-
 In this example we fill up (in parallel) two vectors of the results of a fair
 percentile die and we pick up the maximum values from each cell, and output the
 result.
@@ -34,11 +27,8 @@ result.
 The output will be twenty random integer between 1 and 100, that are clearly
 not uniform distributed as they favor larger numbers.
 
-The code assumes the taskflow is executed once, when using the Framework
-feature the programmer needs care to keep the invariants.
-
-It is then suggested to use const references (eg., vector<int> const&) for the
-objects related to the incoming arcs and references for outcoming ones.
+Since the values live in the tasks, the graph can also be run repeatedly
+as a tf::Framework.
 
 */
 
@@ -65,92 +55,55 @@ std::mt19937 init_mersenne_twister() {
 }
 
 
-class Fill_in_vector {
-public:
-    Fill_in_vector(std::vector<int>& v, int length)
-      : v_{v}, length_{length} {}
-
-    void operator()() {
-        auto rng = init_mersenne_twister();
-        std::uniform_int_distribution<int> percentile_die(1, 100);
+// Function: fill_in_vector
+std::vector<int> fill_in_vector(int length) {
+    auto rng = init_mersenne_twister();
+    std::uniform_int_distribution<int> percentile_die(1, 100);
 
-        //the taskflow is used only once, so we can mess up with length_ value
-        while (length_ > 0) {
-            --length_;
-            v_.push_back( percentile_die(rng) );
-        }
+    std::vector<int> v;
+    while (length > 0) {
+        --length;
+        v.push_back( percentile_die(rng) );
     }
-private:
-    std::vector<int>& v_;
-    int length_;
-};
-
-
-class Pick_up_max {
-public:
-    Pick_up_max(std::vector<int>& in1, std::vector<int>& in2, std::vector<int>& out)
-      : in1_{in1}, in2_{in2}, out_{out} {}
-    void operator()() {
-        for (std::vector<int>::size_type i{}, e = in1_.size(); i < e; ++i) {
-            in1_[i] = std::max(in1_[i], in2_[i]);
-        }
-        // the taskflow is executed once, so we avoid one copy
-        out_.swap(in1_);
+    return v;
+}
+
+
+// Function: pick_up_max
+// The first vector is moved in and reused for the result.
+std::vector<int> pick_up_max(std::vector<int> in1, std::vector<int> in2) {
+    for (std::vector<int>::size_type i{}, e = in1.size(); i < e; ++i) {
+        in1[i] = std::max(in1[i], in2[i]);
     }
-private:
-    std::vector<int>& in1_;
-    std::vector<int>& in2_;
-    std::vector<int>& out_;
-};
-
-
-class Print {
-public:
-    Print(std::vector<int> const& v)
-      : v_{v} {}
-
-    void operator()() {
-        bool first{ true };
-        for (auto i : v_) {
-            if (!first)  {
-                std::cout << ", ";
-            }
-            std::cout << i;
-            first = false;
+    return in1;
+}
+
+
+// Procedure: print
+void print(std::vector<int> const& v) {
+    bool first{ true };
+    for (auto i : v) {
+        if (!first)  {
+            std::cout << ", ";
         }
-        std::cout << "\n";
+        std::cout << i;
+        first = false;
     }
-private:
-    std::vector<int> const& v_;
-};
+    std::cout << "\n";
+}
 
 
 int main() {
-    // Set up the memory for the arcs
-    std::vector<int> in1{}, in2{}, out{};
-
-    // Prepare the functors for taskflow
     tf::Taskflow tf;
-    auto [
-        fill_in_vector1,
-        fill_in_vector2,
-        pick_up_max,
-        print
-    ] = tf.emplace(
-        Fill_in_vector(in1, 20),
-        Fill_in_vector(in2, 20),
-        Pick_up_max(in1, in2, out),
-        Print(out)
-    );
-
-    // Set up dependencies
-    fill_in_vector1.precede(pick_up_max);
-    fill_in_vector2.precede(pick_up_max);
-    pick_up_max.precede(print);
+
+    // The dependencies follow from the inputs of each task
+    auto fill_in_vector1 = tf.dataflow([] () { return fill_in_vector(20); });
+    auto fill_in_vector2 = tf.dataflow([] () { return fill_in_vector(20); });
+    auto max = tf.dataflow(pick_up_max, fill_in_vector1, fill_in_vector2);
+    tf.dataflow(print, max);
 
     // Execution
     tf.wait_for_all();
 
     return 0;
 }
-
@@ -1,60 +1,43 @@
-// A simple example to capture the following task dependencies.
+// A simple example of a three-stage pipeline over four lines:
 //
-// TaskA---->TaskB---->TaskD
-// TaskA---->TaskC---->TaskD
+// serial (generate) ----> parallel (square) ----> serial (print)
+//
+// At most four tokens are in flight, one per line, and each stage keeps
+// its output in a buffer indexed by the line of the token.
 
 #include <taskflow/taskflow.hpp>  // the only include you need
 
 int main(){
 
   tf::Taskflow tf;
-  tf::Framework f;
-
-  std::mutex mtx;
-  
-  auto [A, B, C] = f.emplace( 
-    [&] () { 
-      std::scoped_lock lock(mtx);
-      std::puts("TaskA");
-    },     
-    [&] (auto &subflow) { 
-      std::scoped_lock lock(mtx);
-      std::puts("TaskB");
-      subflow.emplace([&](){
-       std::scoped_lock lock(mtx);
-       std::puts("TaskB1");
-      });
-      subflow.emplace([&](){
-       std::scoped_lock lock(mtx);
-       std::puts("TaskB2");
-      });
-      subflow.detach();
-    },     
-    [&] () { 
-      std::scoped_lock lock(mtx);
-      std::puts("TaskC");
-    }
-  ); 
-
-  A.name("A");
-  B.name("B");
-  C.name("C");
-   
-  // Linear   
-  A.precede(B);  
-  B.precede(C);  
-
-
-  tf.pipeline_until(f, [iter = 3]() mutable { 
-    std::cout << "iter = " << iter << std::endl;
-    return iter -- == 0; }, [](){}
-  ).get();
-
-  //std::cout << f.dump() << std::endl;
-  //tf.wait_for_all();  // block until finished
+
+  constexpr size_t num_lines = 4;
+
+  std::array<int, num_lines> buffer;
+  std::array<long, num_lines> squares;
+
+  tf::Pipeline pl(num_lines,
+    tf::Pipe{tf::PipeType::SERIAL, [&](tf::Pipeflow& pf) {
+      if(pf.token() == 10) {
+        pf.stop();
+      }
+      else {
+        buffer[pf.line()] = static_cast<int>(pf.token());
+      }
+    }},
+    tf::Pipe{tf::PipeType::PARALLEL, [&](tf::Pipeflow& pf) {
+      squares[pf.line()] = static_cast<long>(buffer[pf.line()]) * buffer[pf.line()];
+    }},
+    tf::Pipe{tf::PipeType::SERIAL, [&](tf::Pipeflow& pf) {
+      std::cout << "token " << pf.token() << " on line " << pf.line()
+                << ": " << buffer[pf.line()] << "^2 = " << squares[pf.line()] << '\n';
+    }}
+  );
+
+  tf.run(pl).get();
+
+  std::cout << pl.num_tokens() << " tokens\n";
 
   return 0;
 }
 
-
-
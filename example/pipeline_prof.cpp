@@ -1,8 +1,9 @@
-// A simple example to capture the following task dependencies.
+// Squares the numbers in a text file with a three-stage pipeline, after
+// the text-filter example of TBB:
 //
-// TaskA---->TaskB---->TaskD
-// TaskA---->TaskC---->TaskD
-
+// serial (read a slice) ----> parallel (square) ----> serial (write)
+//
+// Usage: ./pipeline_prof [input.txt] [output.txt] [num_lines]
 
 #include <cstring>
 #include <cstdlib>
@@ -11,115 +12,6 @@
 #include <chrono>
 #include <taskflow/taskflow.hpp>  // the only include you need 
 
-// https://software.intel.com/en-us/forums/intel-moderncode-for-parallel-architectures/topic/297118
-#define compiler_fence() __asm__ __volatile__ ("" : : : "memory")
-
-// load with 'consume' (data-dependent) memory ordering 
-template<typename T> 
-T load_consume(T const* addr) { 
-	// hardware fence is implicit on x86 
-	T v = *const_cast<T const volatile*>(addr); 
-  compiler_fence();
-	//__memory_barrier(); // compiler fence 
-	return v; 
-} 
-
-// store with 'release' memory ordering 
-template<typename T> 
-void store_release(T* addr, T v) { 
-	// hardware fence is implicit on x86 
-	//__memory_barrier(); // compiler fence 
-  compiler_fence();
-	*const_cast<T volatile*>(addr) = v; 
-} 
-
-// cache line size on modern x86 processors (in bytes) 
-size_t const cache_line_size = 64; 
-// single-producer/single-consumer queue 
-template<typename T> 
-class spsc_queue { 
-	public: 
-		spsc_queue() { 
-			node* n = new node; 
-			n->next_ = 0; 
-			tail_ = head_ = first_= tail_copy_ = n; 
-		} 
-
-		~spsc_queue() {  
-			node* n = first_; 
-			do 
-			{ 
-				node* next = n->next_; 
-				delete n; 
-				n = next; 
-			} while (n); 
-		} 
-
-		void enqueue(T v) { 
-			node* n = alloc_node(); 
-			n->next_ = 0; 
-			n->value_ = v; 
-			store_release(&head_->next_, n); 
-			head_ = n; 
-		} 
-
-		// returns 'false' if queue is empty 
-		bool dequeue(T& v) { 
-			if (load_consume(&tail_->next_)) { 
-				v = tail_->next_->value_; 
-				store_release(&tail_, tail_->next_); 
-				return true; 
-			} 
-			else { 
-				return false; 
-			} 
-		} 
-
-	private: 
-		// internal node structure 
-		struct node { 
-			node* next_; 
-			T value_; 
-		}; 
-
-		// consumer part 
-		// accessed mainly by consumer, infrequently be producer 
-		node* tail_; // tail of the queue 
-
-		// delimiter between consumer part and producer part, 
-		// so that they situated on different cache lines 
-		char cache_line_pad_ [cache_line_size]; 
-
-		// producer part 
-		// accessed only by producer 
-		node* head_; // head of the queue 
-		node* first_; // last unused node (tail of node cache) 
-		node* tail_copy_; // helper (points somewhere between first_ and tail_) 
-
-		node* alloc_node() { 
-			// first tries to allocate node from internal node cache, 
-			// if attempt fails, allocates node via ::operator new() 
-
-			if (first_ != tail_copy_) { 
-				node* n = first_; 
-				first_ = first_->next_; 
-				return n; 
-			} 
-			tail_copy_ = load_consume(&tail_); 
-			if (first_ != tail_copy_) { 
-				node* n = first_; 
-				first_ = first_->next_; 
-				return n; 
-			} 
-			node* n = new node; 
-			return n; 
-		} 
-
-		spsc_queue(spsc_queue const&); 
-		spsc_queue& operator = (spsc_queue const&); 
-}; 
-
-
 class TextSlice {
     //! Pointer to one past last character in sequence
     char* logical_end;
@@ -159,37 +51,32 @@ class TextSlice {
 
 
 constexpr size_t MAX_CHAR_PER_INPUT_SLICE = 4000;
-const std::string InputFileName = "input.txt";
-const std::string OutputFileName = "output.txt";
 
-
-bool input_task(TextSlice **next_slice, spsc_queue<TextSlice*>& input_queue, FILE* input_file) {
-  size_t m = (*next_slice)->avail();
-  size_t n = fread( (*next_slice)->end(), 1, m, input_file );
-  if( !n && (*next_slice)->size()==0 ) {
-    // No more characters to process 
-    return true;
+// Function: read_slice
+// Reads the next slice of the input, leaving a partial number at the end
+// for the next slice, or returns nullptr at the end of the input.
+TextSlice* read_slice(TextSlice*& next_slice, FILE* input_file) {
+  size_t m = next_slice->avail();
+  size_t n = fread( next_slice->end(), 1, m, input_file );
+  if( !n && next_slice->size()==0 ) {
+    return nullptr;
   } 
-  else {
-    // Have more characters to process.
-    TextSlice& t = **next_slice;
-    *next_slice = TextSlice::allocate( MAX_CHAR_PER_INPUT_SLICE );
-    char* p = t.end()+n;
-    if( n==m ) {
-      // Might have read partial number.  If so, transfer characters of partial number to next slice.
-      while( p>t.begin() && isdigit(p[-1]) ) {
-        --p;
-      }
-      (*next_slice)->append( p, t.end()+n );
+  TextSlice& t = *next_slice;
+  next_slice = TextSlice::allocate( MAX_CHAR_PER_INPUT_SLICE );
+  char* p = t.end()+n;
+  if( n==m ) {
+    // Might have read partial number.  If so, transfer characters of partial number to next slice.
+    while( p>t.begin() && isdigit(p[-1]) ) {
+      --p;
     }
-    t.set_end(p);
-    input_queue.enqueue(&t);
-    return false;
+    next_slice->append( p, t.end()+n );
   }
+  t.set_end(p);
+  return &t;
 }
 
-
-void output_task(TextSlice* input, spsc_queue<TextSlice*>& output_queue) {
+// Function: square_slice
+TextSlice* square_slice(TextSlice* input) {
   input->end('\0');
   char* p = input->begin();
   TextSlice& out = *TextSlice::allocate( 2*MAX_CHAR_PER_INPUT_SLICE );
@@ -211,159 +98,94 @@ void output_task(TextSlice* input, spsc_queue<TextSlice*>& output_queue) {
   }
   out.set_end(q);
   (*input).free();
-
-  output_queue.enqueue(&out);
+  return &out;
 }
 
-
-void sequential() {
-  auto t1 = std::chrono::high_resolution_clock::now(); 
-  spsc_queue<TextSlice*> input_queue;
-  spsc_queue<TextSlice*> output_queue;
-  FILE* input_file = fopen( InputFileName.c_str(), "r" );
-  FILE* output_file = fopen( OutputFileName.c_str(), "w" );
-
-  size_t num_inputs {0};
-  TextSlice* next_slice = TextSlice::allocate( MAX_CHAR_PER_INPUT_SLICE );
-  while(!input_task(&next_slice, input_queue, input_file)) {
-    num_inputs ++;
+// Procedure: write_slice
+void write_slice(TextSlice* out, FILE* output_file) {
+  size_t n = fwrite( out->begin(), 1, out->size(), output_file );
+  if( n!=out->size() ) {
+    fprintf(stderr,"Can't write into output file\n");
+    exit(1);
   }
+  out->free();
+}
 
-  auto t2 = std::chrono::high_resolution_clock::now(); 
-
-  for(size_t i=0; i<num_inputs; i++) {
-    TextSlice *slice;
-    assert(input_queue.dequeue(slice));
-    output_task(slice, output_queue);
-  }
+// Function: sequential
+double sequential(const char* input, const char* output) {
 
-  auto t3 = std::chrono::high_resolution_clock::now(); 
+  auto beg = std::chrono::high_resolution_clock::now(); 
 
-  for(size_t i=0; i<num_inputs; i++) {
-    TextSlice* out;
-    assert(output_queue.dequeue(out));
+  FILE* input_file = fopen( input, "r" );
+  FILE* output_file = fopen( output, "w" );
 
-    size_t n = fwrite( out->begin(), 1, out->size(), output_file );
-    if( n!=out->size() ) {
-      fprintf(stderr,"Can't write into file '%s'\n", OutputFileName.c_str());
-      exit(1);
-    }
-    out->free();
+  TextSlice* next_slice = TextSlice::allocate( MAX_CHAR_PER_INPUT_SLICE );
+  while(auto slice = read_slice(next_slice, input_file)) {
+    write_slice(square_slice(slice), output_file);
   }
-  auto t4 = std::chrono::high_resolution_clock::now();  
+  next_slice->free();
+  
+  fclose(input_file);
+  fclose(output_file);
 
-  std::cout << std::chrono::duration_cast<std::chrono::microseconds>(t3 - t2).count()/1000000.0 << std::endl;
-  std::cout << std::chrono::duration_cast<std::chrono::microseconds>(t4 - t1).count()/1000000.0 << std::endl;
-  exit(1);
+  auto end = std::chrono::high_resolution_clock::now(); 
+  return std::chrono::duration<double>(end - beg).count();
 }
 
-int main(){
-
-  sequential();
-
+// Function: pipelined
+double pipelined(const char* input, const char* output, size_t num_lines) {
 
-  auto t1 = std::chrono::high_resolution_clock::now(); 
+  auto beg = std::chrono::high_resolution_clock::now(); 
 
-  tf::Taskflow tf(4);
-  tf::Framework f;
-
-  spsc_queue<TextSlice*> input_queue;
-  spsc_queue<TextSlice*> output_queue;
-
-  FILE* input_file = fopen( InputFileName.c_str(), "r" );
-  FILE* output_file = fopen( OutputFileName.c_str(), "w" );
+  FILE* input_file = fopen( input, "r" );
+  FILE* output_file = fopen( output, "w" );
   
-  auto [transform, output] = f.emplace( 
-    [&] () { 
-
-      TextSlice *input;
-      assert(input_queue.dequeue(input));
-
-      input->end('\0');
-      char* p = input->begin();
-      TextSlice& out = *TextSlice::allocate( 2*MAX_CHAR_PER_INPUT_SLICE );
-      char* q = out.begin();
-      for(;;) {
-        while( p<(*input).end() && !isdigit(*p) ) { 
-          *q++ = *p++; 
-        }
-        if( p==(*input).end() ) {
-          break;
-        }
-        long x = strtol( p, &p, 10 );
-        // Note: no overflow checking is needed here, as we have twice the 
-        // input string length, but the square of a non-negative integer n 
-        // cannot have more than twice as many digits as n.
-        long y = x*x; 
-        sprintf(q,"%ld",y);
-        q = strchr(q,0);
-      }
-      out.set_end(q);
-      (*input).free();
-
-      output_queue.enqueue(&out);
-    },     
-    [&] () { 
+  tf::Taskflow tf;
 
-      TextSlice* out;
-      assert(output_queue.dequeue(out));
+  // one slice per line flows from a stage to the next
+  std::vector<TextSlice*> slices(num_lines);
+  TextSlice* next_slice = TextSlice::allocate( MAX_CHAR_PER_INPUT_SLICE );
 
-      size_t n = fwrite( out->begin(), 1, out->size(), output_file );
-      if( n!=out->size() ) {
-          fprintf(stderr,"Can't write into file '%s'\n", OutputFileName.c_str());
-          exit(1);
+  tf::Pipeline pl(num_lines,
+    tf::Pipe{tf::PipeType::SERIAL, [&](tf::Pipeflow& pf) {
+      if(slices[pf.line()] = read_slice(next_slice, input_file); !slices[pf.line()]) {
+        pf.stop();
       }
-      out->free();
-    }
-  ); 
-
-  //transform.name("transform");
-  //output.name("output");
-  transform.name("2");
-  output.name("3");
-
-   
-  // Linear   
-  transform.precede(output);  
+    }},
+    tf::Pipe{tf::PipeType::PARALLEL, [&](tf::Pipeflow& pf) {
+      slices[pf.line()] = square_slice(slices[pf.line()]);
+    }},
+    tf::Pipe{tf::PipeType::SERIAL, [&](tf::Pipeflow& pf) {
+      write_slice(slices[pf.line()], output_file);
+    }}
+  );
+
+  tf.run(pl).get();
+  next_slice->free();
+
+  fclose(input_file);
+  fclose(output_file);
+
+  auto end = std::chrono::high_resolution_clock::now(); 
+  return std::chrono::duration<double>(end - beg).count();
+}
 
-  TextSlice* next_slice = TextSlice::allocate( MAX_CHAR_PER_INPUT_SLICE );
+int main(int argc, char* argv[]){
 
-  tf.pipeline_until(f, [&]() mutable { 
-      // Read characters into space that is available in the next slice.
-      size_t m = next_slice->avail();
-      size_t n = fread( next_slice->end(), 1, m, input_file );
-      if( !n && next_slice->size()==0 ) {
-        // No more characters to process 
-        std::puts("All Done");
-        return true;
-      } 
-      else {
-        // Have more characters to process.
-        TextSlice& t = *next_slice;
-        next_slice = TextSlice::allocate( MAX_CHAR_PER_INPUT_SLICE );
-        char* p = t.end()+n;
-        if( n==m ) {
-          // Might have read partial number.  If so, transfer characters of partial number to next slice.
-          while( p>t.begin() && isdigit(p[-1]) ) {
-            --p;
-          }
-          next_slice->append( p, t.end()+n );
-        }
-        t.set_end(p);
-        input_queue.enqueue(&t);
-        return false;
-        //return &t;
-      }
-    }, 
-    [](){}
-  ).get();
+  const char* input = argc > 1 ? argv[1] : "input.txt";
+  const char* output = argc > 2 ? argv[2] : "output.txt";
+  size_t num_lines = argc > 3 ? std::stoul(argv[3]) : 8;
 
-  auto t2 = std::chrono::high_resolution_clock::now();
-  std::cout << std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count()/1000000.0 << std::endl;
+  if(FILE* f = fopen(input, "r"); f == nullptr) {
+    fprintf(stderr, "Can't read input file '%s'\n", input);
+    return 1;
+  }
+  else {
+    fclose(f);
+  }
+  
+  std::cout << "sequential: " << sequential(input, output) << " s\n";
+  std::cout << "pipelined : " << pipelined(input, output, num_lines) << " s\n";
 
-  std::fclose(input_file);
-  std::fclose(output_file);
   return 0;
 }
-
-
@@ -20,9 +20,24 @@
 #pragma once
 
 #include "topology.hpp"
+#include "../threadpool/cpu_affinity.hpp"
 
 namespace tf {
 
+// Struct: has_run_one
+// Detects executors that can run a pending closure on the calling thread.
+template <typename T, typename = void>
+struct has_run_one : std::false_type {
+};
+
+template <typename T>
+struct has_run_one<T, std::void_t<decltype(std::declval<T&>().run_one())>>
+  : std::true_type {
+};
+
+template <typename T>
+inline constexpr bool has_run_one_v = has_run_one<T>::value;
+
 /** @class BasicTaskflow
 
 @brief The base class to derive a taskflow class.
@@ -39,6 +54,8 @@ class BasicTaskflow : public FlowBuilder {
   
   using StaticWork  = typename Node::StaticWork;
   using DynamicWork = typename Node::DynamicWork;
+  using StreamWork  = typename Node::StreamWork;
+  using ConditionWork = typename Node::ConditionWork;
   
   // Closure
   struct Closure {
@@ -51,11 +68,11 @@ class BasicTaskflow : public FlowBuilder {
     
     void operator ()() ;
 
+    TaskPriority priority() const;
+
     void normal_mode() ;
     void pipeline_mode() ;
 
-    bool execute_pipeline_task(Graph&);
-
     BasicTaskflow* taskflow {nullptr};
     Node*          node     {nullptr};
   };
@@ -78,6 +95,11 @@ class BasicTaskflow : public FlowBuilder {
     @brief constructs the taskflow with N worker threads
     */
     explicit BasicTaskflow(unsigned N);
+
+    /**
+    @brief constructs the taskflow with N worker threads pinned by an affinity policy
+    */
+    BasicTaskflow(unsigned N, const CpuAffinity& affinity);
     
     /**
     @brief constructs the taskflow with a given executor
@@ -102,17 +124,17 @@ class BasicTaskflow : public FlowBuilder {
     /**
     @brief dispatches the present graph to threads and returns immediately
 
-    @return a std::shared_future to access the execution status of the dispatched graph
+    @return a tf::Future to access the execution status of the dispatched graph
     */
-    std::shared_future<void> dispatch();
+    Future dispatch();
     
     /**
     @brief dispatches the present graph to threads and run a callback when the graph completes
 
-    @return a std::shared_future to access the execution status of the dispatched graph
+    @return a tf::Future to access the execution status of the dispatched graph
     */
     template <typename C>
-    std::shared_future<void> dispatch(C&&);
+    Future dispatch(C&&);
   
     /**
     @brief dispatches the present graph to threads and returns immediately
@@ -129,14 +151,47 @@ class BasicTaskflow : public FlowBuilder {
     
     /**
     @brief dispatches the present graph to threads and wait for all topologies to complete
+
+    Rethrows the first exception thrown by a task of the topologies.
     */
     void wait_for_all();
 
     /**
     @brief blocks until all running topologies complete and then
            cleans up all associated storages
+
+    Rethrows the first exception thrown by a task of the topologies.
     */
     void wait_for_topologies();
+
+    /**
+    @brief blocks until a future of this taskflow becomes ready
+
+    In the helping-wait mode, the calling thread runs pending closures of 
+    the executor while it waits. An exception of the run is not rethrown
+    until @c get is called on the future.
+
+    @param future a std::shared_future returned by a dispatch or a run
+    */
+    void wait(const std::shared_future<void>& future);
+
+    /**
+    @brief enables or disables the helping-wait mode
+
+    In this mode, a thread waiting in wait_for_all, wait_for_topologies, 
+    or wait joins the executor as an extra worker and runs pending closures
+    until what it waits for completes, instead of blocking. The mode takes
+    effect only if the executor provides @c run_one() 
+    (e.g., tf::WorkStealingThreadpool); it is disabled by default.
+
+    @param flag @c true to enable the mode
+    */
+    void helping_wait(bool flag);
+
+    /**
+    @brief queries if the helping-wait mode is enabled
+    */
+    bool helping_wait() const;
     
     /**
     @brief dumps the present task dependency graph to a std::ostream in DOT format
@@ -162,6 +217,13 @@ class BasicTaskflow : public FlowBuilder {
     */
     size_t num_workers() const;
 
+    /**
+    @brief queries the number of workers the parallel algorithms size their
+           partitions for, i.e., the current number of worker threads of 
+           the executor and at least one
+    */
+    size_t parallelism() const override;
+
     /**
     @brief queries the number of existing topologies
     */
@@ -182,9 +244,9 @@ class BasicTaskflow : public FlowBuilder {
     
     @param framework a tf::Framework object
 
-    @return a std::shared_future to access the execution status of the framework
+    @return a tf::Future to access the execution status of the framework
     */
-    std::shared_future<void> run(Framework& framework);
+    Future run(Framework& framework);
 
     /**
     @brief runs the framework once and invoke a callback upon completion
@@ -192,10 +254,10 @@ class BasicTaskflow : public FlowBuilder {
     @param framework a tf::Framework object 
     @param callable a callable object to be invoked after this run
 
-    @return a std::shared_future to access the execution status of the framework
+    @return a tf::Future to access the execution status of the framework
     */
     template<typename C>
-    std::shared_future<void> run(Framework& framework, C&& callable);
+    Future run(Framework& framework, C&& callable);
 
     /**
     @brief runs the framework for N times
@@ -203,9 +265,9 @@ class BasicTaskflow : public FlowBuilder {
     @param framework a tf::Framework object
     @param N number of runs
 
-    @return a std::shared_future to access the execution status of the framework
+    @return a tf::Future to access the execution status of the framework
     */
-    std::shared_future<void> run_n(Framework& framework, size_t N);
+    Future run_n(Framework& framework, size_t N);
 
     /**
     @brief runs the framework for N times and invokes a callback upon completion
@@ -214,10 +276,10 @@ class BasicTaskflow : public FlowBuilder {
     @param N number of runs
     @param callable a callable object to be invoked after this run
 
-    @return a std::shared_future to access the execution status of the framework
+    @return a tf::Future to access the execution status of the framework
     */
     template<typename C>
-    std::shared_future<void> run_n(Framework& framework, size_t N, C&& callable);
+    Future run_n(Framework& framework, size_t N, C&& callable);
 
     /**
     @brief runs the framework multiple times until the predicate becomes true and invoke a callback
@@ -225,10 +287,10 @@ class BasicTaskflow : public FlowBuilder {
     @param framework a tf::Framework 
     @param predicate a boolean predicate to return true for stop
 
-    @return a std::shared_future to access the execution status of the framework
+    @return a tf::Future to access the execution status of the framework
     */
     template<typename P>
-    std::shared_future<void> run_until(Framework& framework, P&& predicate);
+    Future run_until(Framework& framework, P&& predicate);
 
     /**
     @brief runs the framework multiple times until the predicate becomes true and invoke a callback
@@ -237,18 +299,35 @@ class BasicTaskflow : public FlowBuilder {
     @param predicate a boolean predicate to return true for stop
     @param callable a callable object to be invoked after this run
 
-    @return a std::shared_future to access the execution status of the framework
+    @return a tf::Future to access the execution status of the framework
     */
     template<typename P, typename C>
-    std::shared_future<void> run_until(Framework& framework, P&& predicate, C&& callable);
+    Future run_until(Framework& framework, P&& predicate, C&& callable);
 
 
-    template<typename P, typename C>
-    std::shared_future<void> pipeline_until(Framework& framework, P&& predicate, C&& callable);
+    /**
+    @brief runs the pipeline until its first pipe stops
+
+    @param pipeline a tf::Pipeline object
+
+    @return a tf::Future to access the execution status of the pipeline
+    */
+    Future run(Pipeline& pipeline);
+
+    /**
+    @brief runs the pipeline until its first pipe stops and invokes a callback upon completion
+
+    @param pipeline a tf::Pipeline object
+    @param callable a callable object to be invoked after this run
+
+    @return a tf::Future to access the execution status of the pipeline
+    */
+    template<typename C>
+    Future run(Pipeline& pipeline, C&& callable);
 
 
     template<typename P, typename C>
-    std::shared_future<void> run_until(WorkGroup& workgroup, P&& predicate, C&& callable);
+    Future run_until(WorkGroup& workgroup, P&& predicate, C&& callable);
 
 
   private:
@@ -259,8 +338,11 @@ class BasicTaskflow : public FlowBuilder {
 
     std::list<Topology, SingularAllocator<Topology>> _topologies;
 
+    bool _helping_wait {false};
+
     void _schedule(Node&);
     void _schedule(PassiveVector<Node*>&);
+    void _retire(Topology&, unsigned);
 
 };
 
@@ -270,48 +352,48 @@ class BasicTaskflow : public FlowBuilder {
 
 // Function: run
 template <template <typename...> typename E>
-std::shared_future<void> BasicTaskflow<E>::run(Framework& f) {
+Future BasicTaskflow<E>::run(Framework& f) {
   return run_n(f, 1, [](){});
 }
 
 // Function: run
 template <template <typename...> typename E>
 template <typename C>
-std::shared_future<void> BasicTaskflow<E>::run(Framework& f, C&& c) {
+Future BasicTaskflow<E>::run(Framework& f, C&& c) {
   static_assert(std::is_invocable<C>::value);
   return run_n(f, 1, std::forward<C>(c));
 }
 
 // Function: run_n
 template <template <typename...> typename E>
-std::shared_future<void> BasicTaskflow<E>::run_n(Framework& f, size_t repeat) {
+Future BasicTaskflow<E>::run_n(Framework& f, size_t repeat) {
   return run_n(f, repeat, [](){});
 }
 
 // Function: run_n
 template <template <typename...> typename E>
 template <typename C>
-std::shared_future<void> BasicTaskflow<E>::run_n(Framework& f, size_t repeat, C&& c) {
+Future BasicTaskflow<E>::run_n(Framework& f, size_t repeat, C&& c) {
   return run_until(f, [repeat]() mutable { return repeat-- == 0; }, std::forward<C>(c));
 }
 
 // Function: run_until
 template <template <typename...> typename E>
 template <typename P>
-std::shared_future<void> BasicTaskflow<E>::run_until(Framework& f, P&& predicate) {
+Future BasicTaskflow<E>::run_until(Framework& f, P&& predicate) {
   return run_until(f, std::forward<P>(predicate), [](){});
 }
 
 // Function: run_until
 template <template <typename...> typename E>
 template <typename P, typename C>
-std::shared_future<void> BasicTaskflow<E>::run_until(Framework& f, P&& predicate, C&& c) {
+Future BasicTaskflow<E>::run_until(Framework& f, P&& predicate, C&& c) {
 
   // Predicate must return a boolean value
   static_assert(std::is_invocable_v<C> && std::is_invocable_v<P>);
 
   if(std::invoke(predicate)) {
-    return std::async(std::launch::deferred, [](){}).share();
+    return Future(std::async(std::launch::deferred, [](){}).share());
   }
   
   // create a topology for this run
@@ -321,17 +403,17 @@ std::shared_future<void> BasicTaskflow<E>::run_until(Framework& f, P&& predicate
   if(num_workers() == 0) {
 
     // Clear last execution data & Build precedence between nodes and target
-    tpg._bind(f._graph);
+    tpg._bind(f, 1);
 
     do {
       _schedule(tpg._sources);
       tpg._recover_num_sinks();
-    } while(!std::invoke(tpg._predicate));
+    } while(!tpg._is_cancelled() && !std::invoke(tpg._predicate));
 
     std::invoke(c);
-    tpg._promise.set_value();
+    tpg._complete();
 
-    return tpg._future;
+    return Future(tpg._future, tpg._cancelled);
   }
 
   // Multi-threaded execution.
@@ -342,13 +424,16 @@ std::shared_future<void> BasicTaskflow<E>::run_until(Framework& f, P&& predicate
   bool run_now = (f._topologies.size() == 1);
 
   if(run_now) {
-    tpg._bind(f._graph);
+    tpg._bind(f, f._overlap);
   }
 
   tpg._work = [&f, c=std::forward<C>(c), this] () mutable {
       
-    // case 1: we still need to run the topology again
-    if(!std::invoke(f._topologies.front()->_predicate)) {
+    // case 1: we still need to run the topology again (overlapped runs 
+    // evaluate the predicate as they admit iterations)
+    if(!f._topologies.front()->_window && 
+       !f._topologies.front()->_is_cancelled() &&
+       !std::invoke(f._topologies.front()->_predicate)) {
       f._topologies.front()->_recover_num_sinks();
       _schedule(f._topologies.front()->_sources); 
     }
@@ -362,9 +447,9 @@ std::shared_future<void> BasicTaskflow<E>::run_until(Framework& f, P&& predicate
       if(f._topologies.size() > 1) {
 
         // Set the promise
-        f._topologies.front()->_promise.set_value();
+        f._topologies.front()->_complete();
         f._topologies.pop_front();
-        f._topologies.front()->_bind(f._graph);
+        f._topologies.front()->_bind(f, f._overlap);
         f._mtx.unlock();
         _schedule(f._topologies.front()->_sources);
       }
@@ -372,12 +457,12 @@ std::shared_future<void> BasicTaskflow<E>::run_until(Framework& f, P&& predicate
         assert(f._topologies.size() == 1);
         // Need to back up the promise first here becuz framework might be 
         // destroy before taskflow leaves
-        auto &p = f._topologies.front()->_promise; 
+        auto &t = *f._topologies.front(); 
         f._topologies.pop_front();
         f._mtx.unlock();
        
         // We set the promise in the end in case framework leaves before taskflow
-        p.set_value();
+        t._complete();
       }
     }
   };
@@ -386,7 +471,7 @@ std::shared_future<void> BasicTaskflow<E>::run_until(Framework& f, P&& predicate
     _schedule(tpg._sources);
   }
 
-  return tpg._future;
+  return Future(tpg._future, tpg._cancelled);
 }
 
 
@@ -394,9 +479,9 @@ std::shared_future<void> BasicTaskflow<E>::run_until(Framework& f, P&& predicate
 // Function: run_until
 template <template <typename...> typename E>
 template <typename P, typename C>
-std::shared_future<void> BasicTaskflow<E>::run_until(WorkGroup& wg, P&& predicate, C&& c) {
+Future BasicTaskflow<E>::run_until(WorkGroup& wg, P&& predicate, C&& c) {
   if(std::invoke(predicate)) {
-    return std::async(std::launch::deferred, [](){}).share();
+    return Future(std::async(std::launch::deferred, [](){}).share());
   }
 
   // create a topology for this run
@@ -457,7 +542,8 @@ std::shared_future<void> BasicTaskflow<E>::run_until(WorkGroup& wg, P&& predicat
   tpg._work = [&wg, c=std::forward<C>(c), this] () mutable {
       
     // case 1: we still need to run the topology again
-    if(!std::invoke(wg._topologies.front()->_predicate)) {
+    if(!wg._topologies.front()->_is_cancelled() &&
+       !std::invoke(wg._topologies.front()->_predicate)) {
       wg._topologies.front()->_recover_num_sinks();
       _schedule(wg._topologies.front()->_sources); 
     }
@@ -470,7 +556,7 @@ std::shared_future<void> BasicTaskflow<E>::run_until(WorkGroup& wg, P&& predicat
       // If there is another run (interleave between lock)
       if(wg._topologies.size() > 1) {
         // Set the promise
-        wg._topologies.front()->_promise.set_value();
+        wg._topologies.front()->_complete();
         wg._topologies.pop_front();
         wg._topologies.front()->_bind(wg._graph);
         wg._mtx.unlock();
@@ -480,12 +566,12 @@ std::shared_future<void> BasicTaskflow<E>::run_until(WorkGroup& wg, P&& predicat
         assert(wg._topologies.size() == 1);
         // Need to back up the promise first here becuz framework might be 
         // destroy before taskflow leaves
-        auto &p = wg._topologies.front()->_promise; 
+        auto &t = *wg._topologies.front(); 
         wg._topologies.pop_front();
         wg._mtx.unlock();
        
         // We set the promise in the end in case framework leaves before taskflow
-        p.set_value();
+        t._complete();
       }
     }
   };
@@ -494,116 +580,116 @@ std::shared_future<void> BasicTaskflow<E>::run_until(WorkGroup& wg, P&& predicat
     _schedule(tpg._sources);
   }
 
-  return tpg._future;
+  return Future(tpg._future, tpg._cancelled);
 }
 
 
 
-// Function: pipeline_until
+// Function: run
 template <template <typename...> typename E>
-template <typename P, typename C>
-std::shared_future<void> BasicTaskflow<E>::pipeline_until(Framework& f, P&& predicate, C&& c) {
-  if(std::invoke(predicate)) {
-    return std::async(std::launch::deferred, [](){}).share();
-  }
+Future BasicTaskflow<E>::run(Pipeline& p) {
+  return run(p, [](){});
+}
+
+// Function: run
+template <template <typename...> typename E>
+template <typename C>
+Future BasicTaskflow<E>::run(Pipeline& p, C&& c) {
+
+  static_assert(std::is_invocable_v<C>);
 
   // create a topology for this run
-  auto &tpg = _topologies.emplace_back(f, std::forward<P>(predicate));
+  auto &tpg = _topologies.emplace_back(p);
 
-  // Iterative execution to avoid stack overflow
+  // Without workers, each token runs through all pipes before the next
   if(num_workers() == 0) {
 
-    // Clear last execution data & Build precedence between nodes and target
-    tpg._bind(f._graph);
+    tpg._bind(p);
 
-    do {
-      _schedule(tpg._sources);
-      tpg._recover_num_sinks();
-    } while(!std::invoke(tpg._predicate));
+    try {
+      for(size_t t=0; ; ++t) {
+        auto& pf = p._pipeflows[t % p.num_lines()];
+        pf._token = t;
+        pf._pipe = 0;
+        p._pipes[0]._callable(pf);
+        if(pf._stop) {
+          break;
+        }
+        ++p._num_tokens;
+        for(pf._pipe=1; pf._pipe<p.num_pipes(); ++pf._pipe) {
+          p._pipes[pf._pipe]._callable(pf);
+        }
+      }
+    }
+    catch(...) {
+      tpg._capture(std::current_exception());
+    }
 
     std::invoke(c);
-    tpg._promise.set_value();
+    tpg._complete();
 
-    return tpg._future;  
+    return Future(tpg._future, tpg._cancelled);
   }
 
   // Multi-threaded execution.
-  std::scoped_lock lock(f._mtx);
+  std::scoped_lock lock(p._mtx);
 
-  f._topologies.push_back(&tpg);
+  p._topologies.push_back(&tpg);
+
+  bool run_now = (p._topologies.size() == 1);
 
-  bool run_now = (f._topologies.size() == 1);
   if(run_now) {
-    // Clear last execution data & Build precedence between nodes and target
-    tpg._bind(f._graph);
-    assert(tpg._sources.size() == 1);
+    tpg._bind(p);
   }
 
-  //tf::Node* predicate_node = new Node();
-  //predicate_node->_topology = &tpg;
-  //predicate_node->_num_dependents = -1;
-  //tpg._work = [predicate_node, &f, c{std::move(c)}]() {
-  tpg._work = [&, c = std::forward<C>(c)]() mutable {
-    printf("Leave\n");
-    //delete predicate_node;
+  tpg._work = [&p, c=std::forward<C>(c), this] () mutable {
+
     std::invoke(c);
 
-    f._mtx.lock();
-    //auto tpg = f._topologies.front();
-    //f._topologies.pop_front();
-    //tpg->_promise.set_value();
+    p._mtx.lock();
 
     // If there is another run (interleave between lock)
-    if(f._topologies.size() > 1) {
-      // Set the promise
-      f._topologies.front()->_promise.set_value();
-      f._topologies.pop_front();
-      f._topologies.front()->_bind(f._graph);
-      f._mtx.unlock();
-      f._topologies.front()->_sources.front()->set_pipeline();
-      _schedule(f._topologies.front()->_sources);
+    if(p._topologies.size() > 1) {
+      p._topologies.front()->_complete();
+      p._topologies.pop_front();
+      p._topologies.front()->_bind(p);
+      p._mtx.unlock();
+      _schedule(p._topologies.front()->_sources);
     }
     else {
-      assert(f._topologies.size() == 1);
-      // Need to back up the promise first here becuz framework might be 
+      assert(p._topologies.size() == 1);
+      // Need to back up the promise first here becuz pipeline might be 
       // destroy before taskflow leaves
-      auto &p = f._topologies.front()->_promise; 
-      f._topologies.pop_front();
-      f._mtx.unlock();
-     
-      // We set the promise in the end in case framework leaves before taskflow
-      p.set_value();
+      auto &t = *p._topologies.front(); 
+      p._topologies.pop_front();
+      p._mtx.unlock();
+      t._complete();
     }
-
   };
 
-  //for(auto &s: tpg._sources) {
-  //  predicate_node->precede(*s);
-  //}
-  //predicate_node->set_pipeline();
-
-  //_schedule(*predicate_node);
- 
-  if(run_now) { 
-    tpg._sources.front()->set_pipeline();
-    _schedule(*(tpg._sources.front()));
+  if(run_now) {
+    _schedule(tpg._sources);
   }
 
-  return tpg._future;
+  return Future(tpg._future, tpg._cancelled);
 }
 
-
 // Constructor
 template <template <typename...> typename E>
 BasicTaskflow<E>::Closure::Closure(BasicTaskflow& t, Node& n) : 
   taskflow{&t}, node {&n} {
 }
 
+// Function: priority
+template <template <typename...> typename E>
+TaskPriority BasicTaskflow<E>::Closure::priority() const {
+  return static_cast<TaskPriority>(node->_priority);
+}
+
 // Operator ()
 template <template <typename...> typename E>
 void BasicTaskflow<E>::Closure::operator () () {
   if(node->is_pipeline()) {
-    assert(false);
     pipeline_mode();
   }
   else {
@@ -612,156 +698,201 @@ void BasicTaskflow<E>::Closure::operator () () {
 }
 
 // Pipeline mode
+// Runs the pipes of a pipeline line while they are ready. Finishing a pipe
+// releases the next pipe on the line and, for a serial pipe, the same pipe
+// on the next line. The task goes on with one released pipe and schedules
+// the other line, and returns once nothing is released. The run completes
+// when no line is being run. A cancelled run stops at the first pipe as if
+// the pipe had stopped the pipeline, and the tokens in flight skip the 
+// other pipes. A pipe that throws cancels the run.
 template <template <typename...> typename E>
 void BasicTaskflow<E>::Closure::pipeline_mode() {
-  bool last_pipe {false};
-  const auto num_successors = node->num_successors();
- 
-  do {
-    ////if(node->_num_dependents == -1) {
-    //if(node->_dependents.size() == 0) {
-    //  if(node->_cur_pipeline == node->_topology->_num_pipeline) {
-    //    return ;
-    //  }
-    //  else {
-    //    auto stop = std::invoke(node->_topology->_predicate); 
-    //    if(!stop) {
-    //      node->_topology->_num_pipeline ++;
-    //    }
-
-    //    for(auto &s: node->_topology->_sources) {
-    //      //if(--s->_num_dependents == 0) {
-    //      //  s->_num_dependents = s->_dependents.size(); 
-    //        if(s->_num_run.fetch_add(1) == 0) {
-    //          s->set_pipeline();
-    //          s->_num_dependents = 0;
-    //          taskflow->_schedule(*s);
-    //        }
-    //      //}
-    //    }                                          
-    //    node->_cur_pipeline ++;
-    //    //node->_num_run = 10;
-    //    continue;
-    //  }
-    //}
-    //else {
 
-      
-      node->_num_dependents = 0;
+  auto topology = node->_topology;
+  auto& pl = *std::get<Pipeline*>(topology->_handle);
+  auto pf = &pl._pipeflows[node->_index];
 
-      //if(node->_subgraph.has_value()) {
-      //  //node->_subgraph.reset();
-      //  node->unset_spawned();
-      //}
+  const size_t num_lines = pl.num_lines();
+  const size_t num_pipes = pl.num_pipes();
 
-      if(!node->is_spawned()) {
-        if(node->_dependents.size() == 0) {
-          auto stop = std::invoke(node->_topology->_predicate); 
-          if(!stop) {
-            node->_topology->_num_pipeline ++;
-          }
-        }
+  while(true) {
 
-        Graph subgraph;
-        if(node->_subgraph.has_value() && !node->_subgraph->empty()) {
-          subgraph.splice(subgraph.begin(), node->_subgraph.value());
-          node->_subgraph.reset();
-        }
-        //if(auto joined = execute_pipeline_node(); joined) {
-        //std::cout << "To execute node ==========  " << node->_name << std::endl;
-        //if(auto joined = execute_node(); joined) {
-        if(auto joined = execute_pipeline_task(subgraph); joined) {
-          std::puts("Join mode");
-          // Recover must be done before scheduling the subgraph, 
-          // otherwise u will have race condition 
-
-          ////node->_round.fetch_sub(1);
-          //if(!backup.empty()) {
-          //  if(!node->_subgraph.has_value()) {
-          //    node->_subgraph.emplace();
-          //  }
-          //  node->_subgraph->splice(node->_subgraph->begin(), backup);
-          //}
-          ////assert(node->_round > 0);
-          return ;
-        }
-        if(!subgraph.empty()) {
-          if(!node->_subgraph.has_value()) {
-            node->_subgraph.emplace();
-          }
-          node->_subgraph.value().splice(node->_subgraph.value().begin(), subgraph);
-        }
-      }
-
-      node->unset_spawned();
+    auto& pipe = pl._pipes[pf->_pipe];
 
-      if(++node->_cur_pipeline == node->_topology->_num_pipeline) {
-        last_pipe = true;
-        node->_num_dependents = node->_dependents.size();
-        node->_cur_pipeline = 0;
-        node->_num_run = 0;
-        node->unset_pipeline();
+    pl._join_counter(pf->_line, pf->_pipe).store(
+      static_cast<int>(pipe._type), std::memory_order_relaxed
+    );
+    
+    if(pf->_pipe == 0) {
+      pf->_token = pl._num_tokens;
+      pf->_stop = false;
+      if(topology->_is_cancelled()) {
+        break;
       }
-
-      for(size_t i=0; i<node->num_successors(); ++i) {
-        //if(--(node->_successors[i]->_num_dependents) == 0) {
-        //  node->_successors[i]->_num_dependents = node->_successors[i]->_dependents.size();
-          if(node->_successors[i]->_num_run.fetch_add(1) == 0) {
-            //std::cout << "Schedule " << node->_successors[i]->_name << std::endl; 
-            node->_successors[i]->set_pipeline();
-            node->_successors[i]->_num_dependents = 0;
-            taskflow->_schedule(*(node->_successors[i]));
-          }
-        //}
+      try {
+        pipe._callable(*pf);
       }
-      //if(node->num_successors() == 0) {
-      if(num_successors == 0) {
-        //if(++node->_cur == node->_topology->_num_run) {
-        if(last_pipe) {
-         //if(node->num_successors() == 0) {
-          if(--(node->_topology->_num_sinks) == 0) {
-            if(node->_topology->_work != nullptr) {
-              printf("Final set value\n");
-              //std::puts("Final set value");
-              std::invoke(node->_topology->_work);
-            }
-          }
-          //no_check = true;
-        }
+      catch(...) {
+        topology->_capture(std::current_exception());
+        break;
+      }
+      if(pf->_stop) {
+        break;
+      }
+      ++pl._num_tokens;
+    }
+    else if(!topology->_is_cancelled()) {
+      try {
+        pipe._callable(*pf);
+      }
+      catch(...) {
+        topology->_capture(std::current_exception());
       }
+    }
 
-    //}  // End of else
+    const size_t curr_pipe = pf->_pipe;
+    const size_t next_pipe = (curr_pipe + 1) % num_pipes;
+    const size_t next_line = (pf->_line + 1) % num_lines;
 
-  } while(!last_pipe && node->_num_run.fetch_sub(1) != 1);
-}
+    pf->_pipe = next_pipe;
 
+    bool down = pipe._type == PipeType::SERIAL &&
+                pl._join_counter(next_line, curr_pipe).fetch_sub(1) == 1;
+
+    bool forward = pl._join_counter(pf->_line, next_pipe).fetch_sub(1) == 1;
+
+    if(down && forward) {
+      topology->_num_sinks ++;
+      taskflow->_schedule(*pl._lines[next_line]);
+    }
+    else if(down) {
+      pf = &pl._pipeflows[next_line];
+    }
+    else if(!forward) {
+      break;
+    }
+  }
+
+  if(--(topology->_num_sinks) == 0) {
+    std::invoke(topology->_work);
+  }
+}
 
 // Normal mode
+// A node of a cancelled run skips its work but still releases its successors,
+// so the join counters are restored for the next run and the sinks complete
+// the run as usual. The first exception thrown by a task is kept for the 
+// future of the run and cancels the rest of the run.
+//
+// A condition task releases only the successor its work selects, without
+// touching the join counter of it. In a run with condition tasks, not every
+// sink may run, so the sink number counts the tasks in flight instead: each
+// scheduled successor adds one and each finished task takes one, and the 
+// run completes when none is left. A cancelled condition task selects no
+// successor, which ends the loops and branches it drives.
 template <template <typename...> typename E>
 void BasicTaskflow<E>::Closure::normal_mode() {
 
+  // A task of a frozen framework releases its successors through the plan,
+  // except for the tasks spawned by a subflow which are not part of it.
+  Topology* topology = node->_topology;
+  Plan* plan = node->is_subtask() ? nullptr : topology->_plan;
+  Window* window = topology->_window.get();
+  const auto slot = node->_slot;
+
   // Here we need to fetch the num_successors first to avoid the invalid memory
   // access caused by topology clear.
-  const auto num_successors = node->num_successors();
+  const auto index = node->_index;
+  const auto num_successors = plan ? 
+    plan->_offsets[index+1] - plan->_offsets[index] : node->num_successors();
+
+  const bool cancelled = topology->_is_cancelled();
+  const bool branched = topology->_branched;
+  const bool is_condition = node->is_condition();
+  int cond {-1};
   
   // regular node type
   // The default node work type. We only need to execute the callback if any.
   if(auto index=node->_work.index(); index == 0) {
-    if(auto &f = std::get<StaticWork>(node->_work); f != nullptr){
-      std::invoke(f);
+    if(auto &f = std::get<StaticWork>(node->_work); f != nullptr && !cancelled){
+      try {
+        std::invoke(f);
+      }
+      catch(...) {
+        topology->_capture(std::current_exception());
+      }
+    }
+  }
+  // condition node type
+  else if(index == 3) {
+    if(!cancelled) {
+      try {
+        cond = std::invoke(std::get<ConditionWork>(node->_work));
+      }
+      catch(...) {
+        topology->_capture(std::current_exception());
+      }
+    }
+  }
+  // stream node type
+  // A stream task that parks on a channel returns its worker and is 
+  // rescheduled by the other end of the channel, which may already run it
+  // again on another worker; the node must not be touched after parking.
+  // A stream task that throws runs again in the cancelled run, which ends
+  // its streams without calling into the user code.
+  else if(index == 2) {
+    Waker waker {taskflow, [] (void* tf, Node& n) {
+      static_cast<BasicTaskflow*>(tf)->_schedule(n);
+    }, topology->_cancelled.get()};
+    auto& f = std::get<StreamWork>(node->_work);
+    bool done;
+    try {
+      done = std::invoke(f, *node, waker);
+    }
+    catch(...) {
+      topology->_capture(std::current_exception());
+      done = std::invoke(f, *node, waker);
+    }
+    if(!done) {
+      return;
     }
   }
   // subflow node type 
   else {
     
-    // Clear the subgraph before the task execution
+    // Clear the subgraph before the task execution. The join counter of the
+    // node gathers its joined subtasks, but a planned node never decrements
+    // its own counter to zero.
     if(!node->is_spawned()) {
       node->_subgraph.emplace();
+      node->_num_dependents = 0;
     }
    
-    SubflowBuilder fb(*(node->_subgraph));
+    SubflowBuilder fb(*(node->_subgraph), std::max(size_t{1}, taskflow->num_workers()));
 
-    std::invoke(std::get<DynamicWork>(node->_work), fb);
+    if(!cancelled) {
+      try {
+        std::invoke(std::get<DynamicWork>(node->_work), fb);
+      }
+      catch(...) {
+        topology->_capture(std::current_exception());
+      }
+    }
+    
+    // Condition tasks are not supported in a subflow; the run fails and
+    // nothing is spawned.
+    if(!node->is_spawned()) {
+      for(auto& n : *(node->_subgraph)) {
+        if(n.is_condition()) {
+          topology->_capture(std::make_exception_ptr(std::system_error(
+            make_error_code(Error::FLOW_BUILDER), 
+            "condition tasks are not supported in subflows"
+          )));
+          node->_subgraph.emplace();
+          break;
+        }
+      }
+    }
     
     // Need to create a subflow if first time & subgraph is not empty 
     if(!node->is_spawned()) {
@@ -771,10 +902,16 @@ void BasicTaskflow<E>::Closure::normal_mode() {
         PassiveVector<Node*> src; 
         for(auto& n : *(node->_subgraph)) {
           n._topology = node->_topology;
+          n._slot = slot;
           n.set_subtask();
           if(n.num_successors() == 0) {
             if(fb.detached()) {
-              node->_topology->_num_sinks ++;
+              if(window) {
+                window->_sinks_of(slot) ++;
+              }
+              else if(!branched) {
+                node->_topology->_num_sinks ++;
+              }
             }
             else {
               n.precede(*node);
@@ -785,6 +922,14 @@ void BasicTaskflow<E>::Closure::normal_mode() {
           }
         }
 
+        // In a branched run, the subtasks are in flight from now on; a 
+        // joined subflow hands its own count over to them, since the node
+        // runs again once they finish. This must be done before scheduling
+        // them, otherwise the count may drop to zero in between.
+        if(branched) {
+          node->_topology->_num_sinks += static_cast<int>(src.size()) - (fb.detached() ? 0 : 1);
+        }
+
         taskflow->_schedule(src);
 
         if(!fb.detached()) {
@@ -801,25 +946,78 @@ void BasicTaskflow<E>::Closure::normal_mode() {
   if(!node->is_subtask()) {
     // Only dynamic tasking needs to restore _dependents
     // TODO:
-    if(node->_work.index() == 1 &&  !node->_subgraph->empty()) {
-      while(!node->_dependents.empty() && node->_dependents.back()->is_subtask()) {
-        node->_dependents.pop_back();
+    if(node->_work.index() == 1) {
+      if(!node->_subgraph->empty()) {
+        while(!node->_dependents.empty() && node->_dependents.back()->is_subtask()) {
+          node->_dependents.pop_back();
+        }
       }
+      node->_num_dependents = branched ? 
+        node->num_strong_dependents() : node->_dependents.size();
+    }
+    else if(plan == nullptr) {
+      node->_num_dependents = branched ? 
+        node->num_strong_dependents() : node->_dependents.size();
     }
-    node->_num_dependents = node->_dependents.size();
     node->clear_status();
   }
 
   // At this point, the node storage might be destructed.
-  for(size_t i=0; i<num_successors; ++i) {
-    if(--(node->_successors[i]->_num_dependents) == 0) {
-      taskflow->_schedule(*(node->_successors[i]));
+  if(is_condition) {
+    if(cond >= 0 && static_cast<size_t>(cond) < num_successors) {
+      auto s = plan ? plan->_nodes[plan->_successors[plan->_offsets[index] + cond]] :
+                      node->_successors[cond];
+      ++(topology->_num_sinks);
+      taskflow->_schedule(*s);
+    }
+  }
+  else if(plan) {
+
+    auto counters = plan->_counters.get();
+    auto joins = plan->_joins.data();
+
+    // The task of the next iteration waits for this one. This must be done
+    // before releasing the successors which may complete the run.
+    if(window) {
+      counters = window->_counters_of(slot);
+      joins = window->_joins.data();
+      node->_slot = window->_next(slot);
+      auto next = window->_counters_of(node->_slot);
+      if(next[index].fetch_sub(1) == 1) {
+        next[index].store(joins[index], std::memory_order_relaxed);
+        taskflow->_schedule(*node);
+      }
+    }
+
+    const auto beg = plan->_offsets[index];
+    for(size_t i=beg; i<beg+num_successors; ++i) {
+      auto s = plan->_successors[i];
+      if(counters[s].fetch_sub(1) == 1) {
+        counters[s].store(joins[s], std::memory_order_relaxed);
+        if(branched) {
+          ++(topology->_num_sinks);
+        }
+        taskflow->_schedule(*(plan->_nodes[s]));
+      }
+    }
+  }
+  else {
+    for(size_t i=0; i<num_successors; ++i) {
+      if(--(node->_successors[i]->_num_dependents) == 0) {
+        if(branched) {
+          ++(topology->_num_sinks);
+        }
+        taskflow->_schedule(*(node->_successors[i]));
+      }
     }
   }
 
   // A node without any successor should check the termination of topology
-  if(num_successors == 0) {
-    if(--(node->_topology->_num_sinks) == 0) {
+  if(num_successors == 0 && window) {
+    taskflow->_retire(*topology, slot);
+  }
+  else if(num_successors == 0 || branched) {
+    if(--(topology->_num_sinks) == 0) {
 
       // This is the last executing node 
       bool is_framework = node->_topology->_handle.index() != 0;
@@ -827,78 +1025,13 @@ void BasicTaskflow<E>::Closure::normal_mode() {
         std::invoke(node->_topology->_work);
       }
       if(!is_framework) {
-        node->_topology->_promise.set_value();
+        node->_topology->_complete();
       }
     }
   }
 }
 
 
-template <template <typename...> typename E>
-bool BasicTaskflow<E>::Closure::execute_pipeline_task(Graph& subgraph) {
-  // regular node type
-  // The default node work type. We only need to execute the callback if any.
-  if(auto index=node->_work.index(); index == 0) {
-    if(auto &f = std::get<StaticWork>(node->_work); f != nullptr){
-      std::invoke(f);
-    }
-  }
-  // subflow node type 
-  else {
-    
-    // Clear the subgraph before the task execution
-    if(!node->is_spawned()) {
-      node->_subgraph.emplace();
-    }
-   
-    SubflowBuilder fb(*(node->_subgraph));
-
-    std::invoke(std::get<DynamicWork>(node->_work), fb);
-    
-    // Need to create a subflow if first time & subgraph is not empty 
-    if(!node->is_spawned()) {
-      node->set_spawned();
-      if(!node->_subgraph->empty()) {
-        // For storing the source nodes
-        PassiveVector<Node*> src; 
-        for(auto& n : *(node->_subgraph)) {
-          n._topology = node->_topology;
-          n.set_subtask();
-          if(n.num_successors() == 0) {
-            if(fb.detached()) {
-              node->_topology->_num_sinks ++;
-            }
-            else {
-              n.precede(*node);
-            }
-          }
-          if(n.num_dependents() == 0) {
-            src.push_back(&n);
-          }
-        }
-
-        if(!fb.detached()) {
-          if(!subgraph.empty()) {
-            if(!node->_subgraph.has_value()) {
-              node->_subgraph.emplace();
-            }
-            node->_subgraph->splice(node->_subgraph->begin(), subgraph);
-          }
-        }
-
-        taskflow->_schedule(src);
-
-        if(!fb.detached()) {
-          // Return true only when joining with parent
-          return true;
-        }
-      }
-    }
-  } // End of DynamicWork -----------------------------------------------------
-  
-  return false;
-}
-
 // ============================================================================
 // BasicTaskflow Method Definitions
 // ============================================================================
@@ -917,6 +1050,13 @@ BasicTaskflow<E>::BasicTaskflow(unsigned N) :
   _executor {std::make_shared<Executor>(N)} {
 }
 
+// Constructor
+template <template <typename...> typename E>
+BasicTaskflow<E>::BasicTaskflow(unsigned N, const CpuAffinity& affinity) : 
+  FlowBuilder {_graph},
+  _executor {std::make_shared<Executor>(N, affinity)} {
+}
+
 // Constructor
 template <template <typename...> typename E>
 BasicTaskflow<E>::BasicTaskflow(std::shared_ptr<Executor> e) :
@@ -931,9 +1071,14 @@ BasicTaskflow<E>::BasicTaskflow(std::shared_ptr<Executor> e) :
 }
 
 // Destructor
+// The exceptions of the runs are left to their futures.
 template <template <typename...> typename E>
 BasicTaskflow<E>::~BasicTaskflow() {
-  wait_for_topologies();
+  try {
+    wait_for_topologies();
+  }
+  catch(...) {
+  }
 }
 
 // Function: num_nodes
@@ -948,6 +1093,12 @@ size_t BasicTaskflow<E>::num_workers() const {
   return _executor->num_workers();
 }
 
+// Function: parallelism
+template <template <typename...> typename E>
+size_t BasicTaskflow<E>::parallelism() const {
+  return std::max(size_t{1}, num_workers());
+}
+
 // Function: num_topologies
 template <template <typename...> typename E>
 size_t BasicTaskflow<E>::num_topologies() const {
@@ -989,35 +1140,35 @@ void BasicTaskflow<E>::silent_dispatch(C&& c) {
 
 // Procedure: dispatch 
 template <template <typename...> typename E>
-std::shared_future<void> BasicTaskflow<E>::dispatch() {
+Future BasicTaskflow<E>::dispatch() {
 
   if(_graph.empty()) {
-    return std::async(std::launch::deferred, [](){}).share();
+    return Future(std::async(std::launch::deferred, [](){}).share());
   }
 
   auto& topology = _topologies.emplace_back(std::move(_graph));
  
   _schedule(topology._sources);
 
-  return topology._future;
+  return Future(topology._future, topology._cancelled);
 }
 
 
 // Procedure: dispatch with registered callback
 template <template <typename...> typename E>
 template <typename C>
-std::shared_future<void> BasicTaskflow<E>::dispatch(C&& c) {
+Future BasicTaskflow<E>::dispatch(C&& c) {
 
   if(_graph.empty()) {
     c();
-    return std::async(std::launch::deferred, [](){}).share();
+    return Future(std::async(std::launch::deferred, [](){}).share());
   }
 
   auto& topology = _topologies.emplace_back(std::move(_graph), std::forward<C>(c));
 
   _schedule(topology._sources);
 
-  return topology._future;
+  return Future(topology._future, topology._cancelled);
 }
 
 // Procedure: wait_for_all
@@ -1030,12 +1181,58 @@ void BasicTaskflow<E>::wait_for_all() {
 }
 
 // Procedure: wait_for_topologies
+// Waits for all topologies before rethrowing the first exception of them.
 template <template <typename...> typename E>
 void BasicTaskflow<E>::wait_for_topologies() {
+  std::exception_ptr exception;
   for(auto& t: _topologies){
-    t._future.get();
+    wait(t._future);
+    if(!exception) {
+      exception = t._exception;
+    }
   }
   _topologies.clear();
+  if(exception) {
+    std::rethrow_exception(exception);
+  }
+}
+
+// Procedure: wait
+// A helping thread polls the future between closures. When it finds no 
+// closure to run, it yields for a few rounds and then blocks on the future
+// for a doubling period of up to one millisecond before polling again.
+template <template <typename...> typename E>
+void BasicTaskflow<E>::wait(const std::shared_future<void>& future) {
+
+  if constexpr(has_run_one_v<Executor>) {
+    if(_helping_wait) {
+      for(unsigned r=0; future.wait_for(std::chrono::seconds(0)) == std::future_status::timeout; ) {
+        if(_executor->run_one()) {
+          r = 0;
+        }
+        else if(++r <= 16) {
+          std::this_thread::yield();
+        }
+        else {
+          future.wait_for(std::chrono::microseconds(1 << std::min(r - 16, 10u)));
+        }
+      }
+    }
+  }
+
+  future.wait();
+}
+
+// Procedure: helping_wait
+template <template <typename...> typename E>
+void BasicTaskflow<E>::helping_wait(bool flag) {
+  _helping_wait = flag;
+}
+
+// Function: helping_wait
+template <template <typename...> typename E>
+bool BasicTaskflow<E>::helping_wait() const {
+  return _helping_wait;
 }
 
 // Procedure: _schedule
@@ -1047,6 +1244,51 @@ void BasicTaskflow<E>::_schedule(Node& node) {
 }
 
 
+// Procedure: _retire
+// Retires a sink of the iteration in the given slot of an overlapped run. 
+// The last sink of an iteration completes it once the previous iteration 
+// has completed, which admits iteration k + window size into the freed 
+// slot, or finishes the run after the last admitted iteration. Iterations
+// complete in order, so the window counts which iteration k completes.
+template <template <typename...> typename E>
+void BasicTaskflow<E>::_retire(Topology& tpg, unsigned slot) {
+
+  auto& w = *tpg._window;
+
+  while(w._sinks_of(slot).fetch_sub(1) == 1) {
+
+    const size_t k = w._num_completed++;
+
+    w._sinks_of(slot).store(w._num_sinks + 1, std::memory_order_relaxed);
+
+    if(!w._stopped) {
+      if(tpg._is_cancelled() || std::invoke(tpg._predicate)) {
+        w._stopped = true;
+      }
+      else {
+        auto counters = w._counters_of(k + w._size);
+        PassiveVector<Node*> ready;
+        for(auto src : tpg._plan->_sources) {
+          if(counters[src->_index].fetch_sub(1) == 1) {
+            counters[src->_index].store(w._joins[src->_index], std::memory_order_relaxed);
+            ready.push_back(src);
+          }
+        }
+        ++w._num_issued;
+        _schedule(ready);
+      }
+    }
+
+    // The run may be destructed once it finishes.
+    if(w._stopped && k + 1 == w._num_issued) {
+      std::invoke(tpg._work);
+      return;
+    }
+
+    slot = w._next(slot);
+  }
+}
+
 // Procedure: _schedule
 // The main procedure to schedule a set of task nodes.
 // Each task node has two types of tasks - regular and subflow.
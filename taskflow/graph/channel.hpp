@@ -0,0 +1,221 @@
+#pragma once
+
+#include "graph.hpp"
+
+namespace tf {
+
+/**
+@class Channel
+
+@brief A bounded single-producer single-consumer stream of items between
+       two tasks.
+
+A channel connects a task created by tf::FlowBuilder::produce (or the output
+of tf::FlowBuilder::transform) to a task created by tf::FlowBuilder::consume
+(or the input of tf::FlowBuilder::transform). Both tasks run at the same
+time and the channel holds at most @c capacity items in flight, which bounds
+the memory of the stream regardless of its length.
+
+Neither end blocks a worker. When the channel is full, the producer parks
+on it and returns its worker to the executor; the consumer reschedules the
+producer as soon as it frees a slot. Likewise, a consumer parks on an empty
+channel and is rescheduled when an item arrives or the stream ends.
+
+Since both ends must be able to run at once, the producer and the consumer
+of a channel must not depend on each other through task edges. After the
+consumer drains a finished stream, the channel is ready for the next run
+of the graph. If the run is cancelled, the producer ends the stream and the
+consumer drops the items in flight, which also leaves the channel ready.
+
+@code{.cpp}
+tf::Channel<int> channel(16);
+int i = 0, sum = 0;
+auto P = taskflow.produce(channel, [&] () -> std::optional<int> {
+  if(i == 1000) return std::nullopt;
+  return i++;
+});
+auto C = taskflow.consume(channel, [&] (int item) { sum += item; });
+@endcode
+*/
+template <typename T>
+class Channel {
+
+  friend class FlowBuilder;
+
+  constexpr static size_t cacheline_size = 64;
+
+  constexpr static int PRODUCER = 0;
+  constexpr static int CONSUMER = 1;
+
+  public:
+
+    /**
+    @brief the type of the items
+    */
+    using value_type = T;
+
+    /**
+    @brief constructs a channel holding at most @c capacity items
+    */
+    explicit Channel(size_t capacity);
+
+    Channel(const Channel&) = delete;
+    Channel& operator = (const Channel&) = delete;
+
+    /**
+    @brief queries the maximum number of items in flight
+    */
+    size_t capacity() const;
+
+    /**
+    @brief queries the number of items in flight
+    */
+    size_t size() const;
+
+    /**
+    @brief queries if the channel holds no item
+    */
+    bool empty() const;
+
+  private:
+
+    std::vector<std::optional<T>> _slots;
+
+    // The consumer owns the head and the producer owns the tail; each is
+    // written by one end only and kept on its own cache line.
+    alignas(cacheline_size) std::atomic<size_t> _head {0};
+    alignas(cacheline_size) std::atomic<size_t> _tail {0};
+
+    alignas(cacheline_size) std::atomic<bool> _closed {false};
+
+    std::atomic<Node*> _parked[2] {nullptr, nullptr};
+    Waker _wakers[2];
+
+    bool _full() const;
+    bool _starved() const;
+    bool _drained() const;
+
+    void _push(T&&);
+    std::optional<T> _pop();
+    void _close();
+    void _reopen();
+
+    bool _park(int, Node&, const Waker&, bool (Channel::*)() const);
+    void _wake(int);
+};
+
+// Constructor
+template <typename T>
+Channel<T>::Channel(size_t capacity) : _slots(capacity) {
+  if(capacity == 0) {
+    TF_THROW(Error::FLOW_BUILDER, "a channel needs a capacity of at least one");
+  }
+}
+
+// Function: capacity
+template <typename T>
+size_t Channel<T>::capacity() const {
+  return _slots.size();
+}
+
+// Function: size
+template <typename T>
+size_t Channel<T>::size() const {
+  return _tail.load() - _head.load();
+}
+
+// Function: empty
+template <typename T>
+bool Channel<T>::empty() const {
+  return size() == 0;
+}
+
+// Function: _full
+template <typename T>
+bool Channel<T>::_full() const {
+  return size() == capacity();
+}
+
+// Function: _starved
+// The consumer has to wait for an item or the end of the stream.
+template <typename T>
+bool Channel<T>::_starved() const {
+  return empty() && !_closed.load();
+}
+
+// Function: _drained
+// The closed flag is read before the items, so every item pushed before the
+// stream ended is seen.
+template <typename T>
+bool Channel<T>::_drained() const {
+  return _closed.load() && empty();
+}
+
+// Procedure: _push
+template <typename T>
+void Channel<T>::_push(T&& item) {
+  auto tail = _tail.load(std::memory_order_relaxed);
+  _slots[tail % capacity()].emplace(std::move(item));
+  _tail.store(tail + 1);
+  _wake(CONSUMER);
+}
+
+// Function: _pop
+template <typename T>
+std::optional<T> Channel<T>::_pop() {
+  auto head = _head.load(std::memory_order_relaxed);
+  if(head == _tail.load()) {
+    return std::nullopt;
+  }
+  auto& slot = _slots[head % capacity()];
+  std::optional<T> item {std::move(slot)};
+  slot.reset();
+  _head.store(head + 1);
+  _wake(PRODUCER);
+  return item;
+}
+
+// Procedure: _close
+template <typename T>
+void Channel<T>::_close() {
+  _closed.store(true);
+  _wake(CONSUMER);
+}
+
+// Procedure: _reopen
+template <typename T>
+void Channel<T>::_reopen() {
+  _closed.store(false);
+}
+
+// Function: _park
+// Publishes the node as parked on one end and checks again whether it has
+// to wait. Both the publication and the state the other end changes before
+// waking are sequentially consistent, so either the other end sees the
+// parked node or this end sees the change. If the node can go on, it takes
+// itself back unless the other end has already taken it to reschedule it.
+// Returns true if the node is parked and the caller must yield.
+template <typename T>
+bool Channel<T>::_park(
+  int end, Node& node, const Waker& waker, bool (Channel::*wait)() const
+) {
+  _wakers[end] = waker;
+  _parked[end].store(&node);
+  if((this->*wait)()) {
+    return true;
+  }
+  return _parked[end].exchange(nullptr) == nullptr;
+}
+
+// Procedure: _wake
+template <typename T>
+void Channel<T>::_wake(int end) {
+  if(_parked[end].load() != nullptr) {
+    if(auto node = _parked[end].exchange(nullptr); node != nullptr) {
+      _wakers[end](*node);
+    }
+  }
+}
+
+}  // end of namespace tf. ---------------------------------------------------
+
@@ -1,6 +1,8 @@
 #pragma once
 
-#include "task.hpp"
+#include "value_task.hpp"
+#include "channel.hpp"
+#include "partitioner.hpp"
 
 namespace tf {
 
@@ -18,15 +20,20 @@ class FlowBuilder {
     @brief construct a flow builder object
 
     @param graph a task dependency graph to manipulate
+    @param parallelism the number of workers to size parallel algorithms for,
+                       or zero to size them when the graph runs
     */
-    FlowBuilder(Graph& graph);
+    FlowBuilder(Graph& graph, size_t parallelism = 0);
     
     /**
     @brief creates a task from a given callable object
+
+    A callable taking a tf::SubflowBuilder& creates a subflow task. The 
+    return value of any other callable is discarded.
     
     @tparam C callable type
     
-    @param callable a callable object acceptable to std::function
+    @param callable a callable object, which may be move-only
 
     @return Task handle
     */
@@ -38,7 +45,7 @@ class FlowBuilder {
     
     @tparam C... callable types
 
-    @param callables one or multiple callable objects acceptable to std::function
+    @param callables one or multiple callable objects, which may be move-only
 
     @return a Task handle
     */
@@ -96,6 +103,45 @@ class FlowBuilder {
     */
     template <typename I, typename C, std::enable_if_t<std::is_arithmetic_v<I>, void>* = nullptr >
     std::pair<Task, Task> parallel_for(I beg, I end, I step, C&& callable, size_t chunk = 0);
+
+    /**
+    @brief constructs a task dependency graph of range-based parallel_for
+           divided among tasks by a partitioner
+    
+    With a tf::StaticPartitioner this is the same as passing its chunk size.
+    With the other partitioners, the graph holds one task per worker
+    and the chunks are handed out to the tasks at run time.
+
+    @tparam I input iterator type
+    @tparam C callable type
+
+    @param beg iterator to the beginning (inclusive)
+    @param end iterator to the end (exclusive)
+    @param callable a callable object to be applied to 
+    @param partitioner the partitioning policy and chunk size
+
+    @return a pair of Task handles to the beginning and the end of the graph
+    */
+    template <typename I, typename C>
+    std::pair<Task, Task> parallel_for(I beg, I end, C&& callable, const Partitioner& partitioner);
+    
+    /**
+    @brief constructs a task dependency graph of index-based parallel_for
+           divided among tasks by a partitioner
+    
+    @tparam I arithmetic index type
+    @tparam C callable type
+
+    @param beg index to the beginning (inclusive)
+    @param end index to the end (exclusive)
+    @param step step size 
+    @param callable a callable object to be applied to
+    @param partitioner the partitioning policy and chunk size
+
+    @return a pair of Task handles to the beginning and the end of the graph
+    */
+    template <typename I, typename C, std::enable_if_t<std::is_arithmetic_v<I>, void>* = nullptr >
+    std::pair<Task, Task> parallel_for(I beg, I end, I step, C&& callable, const Partitioner& partitioner);
     
     /**
     @brief construct a task dependency graph of parallel reduction
@@ -203,13 +249,379 @@ class FlowBuilder {
     */
     template <typename I, typename T, typename B, typename P, typename U>
     std::pair<Task, Task> transform_reduce(I beg, I end, T& result, B&& bop1, P&& bop2, U&& uop);
+
+    /**
+    @brief constructs a task dependency graph of parallel_for over a container
+           whose range is read when the graph runs
+
+    The container is held by reference and its range is read each time the
+    graph runs, by a subflow task that splits it into subtasks. A tf::Framework
+    can therefore follow a container that grows or shrinks between runs.
+
+    @code{.cpp}
+    std::vector<int> data;
+    framework.parallel_for(std::ref(data), [] (int& item) { item++; });
+    @endcode
+
+    @tparam R container type
+    @tparam C callable type
+
+    @param range a reference wrapper to the container
+    @param callable a callable object to be applied to every item
+    @param chunk number of works per thread
+
+    @return a pair of Task handles to the beginning and the end of the graph
+    */
+    template <typename R, typename C>
+    std::pair<Task, Task> parallel_for(std::reference_wrapper<R> range, C&& callable, size_t chunk = 0);
+
+    /**
+    @brief constructs a task dependency graph of parallel_for over a container
+           whose range is read when the graph runs, divided by a partitioner
+    */
+    template <typename R, typename C>
+    std::pair<Task, Task> parallel_for(std::reference_wrapper<R> range, C&& callable, const Partitioner& partitioner);
+
+    /**
+    @brief constructs a task dependency graph of index-based parallel_for
+           whose bounds are read when the graph runs
+
+    The bounds are held by reference. A zero step throws when the graph is 
+    built; bounds that lead away from the step run no iteration.
+
+    @tparam I index type of the beginning 
+    @tparam J index type of the end
+    @tparam C callable type
+
+    @param beg a reference wrapper to the index to the beginning (inclusive)
+    @param end a reference wrapper to the index to the end (exclusive)
+    @param step step size 
+    @param callable a callable object to be applied to
+    @param chunk number of works per thread
+
+    @return a pair of Task handles to the beginning and the end of the graph
+    */
+    template <typename I, typename J, typename C, 
+      std::enable_if_t<std::is_arithmetic_v<std::remove_cv_t<I>>, void>* = nullptr
+    >
+    std::pair<Task, Task> parallel_for(
+      std::reference_wrapper<I> beg, std::reference_wrapper<J> end, 
+      std::remove_cv_t<I> step, C&& callable, size_t chunk = 0
+    );
+
+    /**
+    @brief constructs a task dependency graph of parallel reduction over a 
+           container whose range is read when the graph runs
+
+    @tparam R container type
+    @tparam T data type
+    @tparam B binary operator type
+
+    @param range  a reference wrapper to the container
+    @param result reference variable to store the final result
+    @param bop    binary operator that will be applied in unspecified order to the items
+    
+    @return a pair of Task handles to the beginning and the end of the graph
+    */
+    template <typename R, typename T, typename B>
+    std::pair<Task, Task> reduce(std::reference_wrapper<R> range, T& result, B&& bop);
+
+    /**
+    @brief constructs a task dependency graph of parallel reduction through @std_min
+           over a container whose range is read when the graph runs
+    */
+    template <typename R, typename T>
+    std::pair<Task, Task> reduce_min(std::reference_wrapper<R> range, T& result);
+
+    /**
+    @brief constructs a task dependency graph of parallel reduction through @std_max
+           over a container whose range is read when the graph runs
+    */
+    template <typename R, typename T>
+    std::pair<Task, Task> reduce_max(std::reference_wrapper<R> range, T& result);
+
+    /**
+    @brief constructs a task dependency graph of parallel transformation and 
+           reduction over a container whose range is read when the graph runs
+
+    @tparam R container type
+    @tparam T data type
+    @tparam B binary operator type
+    @tparam U unary operator type
+
+    @param range  a reference wrapper to the container
+    @param result reference variable to store the final result
+    @param bop    binary function object that will be applied in unspecified order 
+                  to the results of @c uop; the return type must be @c T
+    @param uop    unary function object that transforms each item
+    
+    @return a pair of Task handles to the beginning and the end of the graph
+    */
+    template <typename R, typename T, typename B, typename U>
+    std::pair<Task, Task> transform_reduce(std::reference_wrapper<R> range, T& result, B&& bop, U&& uop);
+
+    /**
+    @brief constructs a task dependency graph of two-layer parallel transformation
+           and reduction over a container whose range is read when the graph runs
+    */
+    template <typename R, typename T, typename B, typename P, typename U>
+    std::pair<Task, Task> transform_reduce(
+      std::reference_wrapper<R> range, T& result, B&& bop1, P&& bop2, U&& uop
+    );
+
+    /**
+    @brief constructs a task dependency graph of parallel inclusive scan
+
+    The task dependency graph writes to the i-th output the reduction of the
+    first i+1 items in the range [beg, end) through a binary operator, as 
+    @std_inclusive_scan does. The range is cut into one contiguous block per
+    worker, each scanned from the reduction of the blocks before it. The
+    output may be the input range itself.
+
+    @tparam I input iterator type
+    @tparam O output iterator type, which must be a forward iterator
+    @tparam B binary operator type
+
+    @param beg iterator to the beginning (inclusive)
+    @param end iterator to the end (exclusive)
+    @param out iterator to the beginning of the output range
+    @param bop associative binary operator
+
+    @return a pair of Task handles to the beginning and the end of the graph
+    */
+    template <typename I, typename O, typename B>
+    std::pair<Task, Task> inclusive_scan(I beg, I end, O out, B&& bop);
+
+    /**
+    @brief constructs a task dependency graph of parallel exclusive scan
+
+    The task dependency graph writes to the i-th output the reduction of the 
+    initial value and the first i items in the range [beg, end) through a 
+    binary operator, as @std_exclusive_scan does.
+
+    @tparam I input iterator type
+    @tparam O output iterator type, which must be a forward iterator
+    @tparam T initial value type
+    @tparam B binary operator type
+
+    @param beg iterator to the beginning (inclusive)
+    @param end iterator to the end (exclusive)
+    @param out iterator to the beginning of the output range
+    @param init initial value
+    @param bop associative binary operator
+
+    @return a pair of Task handles to the beginning and the end of the graph
+    */
+    template <typename I, typename O, typename T, typename B>
+    std::pair<Task, Task> exclusive_scan(I beg, I end, O out, T init, B&& bop);
+
+    /**
+    @brief constructs a task dependency graph of parallel transformation and
+           inclusive scan
+
+    The same as tf::FlowBuilder::inclusive_scan on the results of a unary 
+    operator applied to every item. The unary operator is applied twice to
+    the items of all but the first and last blocks.
+
+    @tparam I input iterator type
+    @tparam O output iterator type, which must be a forward iterator
+    @tparam B binary operator type
+    @tparam U unary operator type
+
+    @param beg iterator to the beginning (inclusive)
+    @param end iterator to the end (exclusive)
+    @param out iterator to the beginning of the output range
+    @param bop associative binary operator
+    @param uop unary operator applied to every item before the scan
+
+    @return a pair of Task handles to the beginning and the end of the graph
+    */
+    template <typename I, typename O, typename B, typename U>
+    std::pair<Task, Task> transform_inclusive_scan(I beg, I end, O out, B&& bop, U&& uop);
+
+    /**
+    @brief constructs a task dependency graph of parallel transformation and
+           exclusive scan
+
+    The same as tf::FlowBuilder::exclusive_scan on the results of a unary 
+    operator applied to every item.
+
+    @tparam I input iterator type
+    @tparam O output iterator type, which must be a forward iterator
+    @tparam T initial value type
+    @tparam B binary operator type
+    @tparam U unary operator type
+
+    @param beg iterator to the beginning (inclusive)
+    @param end iterator to the end (exclusive)
+    @param out iterator to the beginning of the output range
+    @param init initial value
+    @param bop associative binary operator
+    @param uop unary operator applied to every item before the scan
+
+    @return a pair of Task handles to the beginning and the end of the graph
+    */
+    template <typename I, typename O, typename T, typename B, typename U>
+    std::pair<Task, Task> transform_exclusive_scan(I beg, I end, O out, T init, B&& bop, U&& uop);
+
+    /**
+    @brief constructs a task dependency graph of parallel merge sort
+
+    The task dependency graph sorts one contiguous block of the range 
+    [beg, end) per worker with @std_sort and merges the sorted blocks in 
+    rounds. Every round is split into one task per block, each merging its
+    share of the output found by binary search, so no round is serial. 
+    Ranges too small to split are sorted by a single task. 
+    
+    The merge rounds need a scratch buffer as large as the range, which is
+    allocated when the graph runs and released when the sort is done.
+    Like @std_sort, the sort is not stable.
+
+    @tparam I random-access iterator type
+    @tparam C comparator type
+
+    @param beg iterator to the beginning (inclusive)
+    @param end iterator to the end (exclusive)
+    @param cmp comparator, which returns true if its first argument is ordered
+               before its second
+
+    @return a pair of Task handles to the beginning and the end of the graph
+    */
+    template <typename I, typename C>
+    std::pair<Task, Task> sort(I beg, I end, C&& cmp);
+
+    /**
+    @brief constructs a task dependency graph of parallel merge sort through 
+           @c std::less
+    */
+    template <typename I>
+    std::pair<Task, Task> sort(I beg, I end);
+
+    /**
+    @brief constructs a task dependency graph of parallel merge sort using a 
+           given scratch buffer
+
+    The same as tf::FlowBuilder::sort, except that the merge rounds move the
+    items through the given scratch buffer of at least as many items as the 
+    range, so the sort allocates no memory when it runs.
+
+    @tparam I random-access iterator type
+    @tparam S random-access iterator type of the scratch buffer
+    @tparam C comparator type
+
+    @param beg iterator to the beginning (inclusive)
+    @param end iterator to the end (exclusive)
+    @param scratch iterator to the beginning of the scratch buffer
+    @param cmp comparator
+
+    @return a pair of Task handles to the beginning and the end of the graph
+    */
+    template <typename I, typename S, typename C>
+    std::pair<Task, Task> sort(I beg, I end, S scratch, C&& cmp);
+
+    /**
+    @brief creates a task that passes the values of other tasks to a callable
+           and returns the result of the callable to its successors
+
+    The task succeeds each input and invokes the callable with the value
+    of each input as an rvalue argument, in order. See tf::ValueTask for 
+    how values are stored and passed.
+
+    @tparam C callable type
+    @tparam Ts value types of the inputs
+
+    @param callable a callable object invocable with rvalues of @c Ts...
+    @param inputs zero or more value tasks whose values the callable takes
+
+    @return a tf::ValueTask of the result of the callable, or a tf::Task if 
+            the callable returns @c void
+    */
+    template <typename C, typename... Ts>
+    auto dataflow(C&& callable, const ValueTask<Ts>&... inputs);
     
+    /**
+    @brief creates a task that streams items into a channel
+
+    The task calls the generator repeatedly and pushes each item it returns
+    into the channel until the generator returns @c std::nullopt, which ends
+    the stream. The task yields its worker whenever the channel is full.
+
+    @tparam T item type
+    @tparam G generator type
+
+    @param channel the channel to produce into
+    @param generator a callable object returning @c std::optional<T>
+
+    @return a Task handle
+    */
+    template <typename T, typename G>
+    Task produce(Channel<T>& channel, G&& generator);
+
+    /**
+    @brief creates a task that applies a callable object to every item of a channel
+
+    The task finishes when the producer ended the stream and all of its items 
+    have been consumed. It yields its worker whenever the channel is empty.
+
+    @tparam T item type
+    @tparam C callable type
+
+    @param channel the channel to consume from
+    @param callable a callable object invocable with an item of type @c T
+
+    @return a Task handle
+    */
+    template <typename T, typename C>
+    Task consume(Channel<T>& channel, C&& callable);
+
+    /**
+    @brief creates a task that consumes the items of one channel and produces
+           the results of a callable object on them into another
+
+    The task ends its output stream when its input stream ends, so transforms
+    can be chained between a producer and a consumer.
+
+    @tparam T input item type
+    @tparam U output item type
+    @tparam C callable type
+
+    @param in the channel to consume from
+    @param out the channel to produce into
+    @param callable a callable object taking an item of type @c T and 
+                    returning an item convertible to @c U
+
+    @return a Task handle
+    */
+    template <typename T, typename U, typename C>
+    Task transform(Channel<T>& in, Channel<U>& out, C&& callable);
+
     /**
     @brief creates an empty task
 
     @return a Task handle
     */
     Task placeholder();
+
+    /**
+    @brief creates a condition task from a callable returning an index
+
+    A condition task runs only the successor at the index the callable 
+    returns, or none if the index is out of range. Its edges are weak: they
+    do not count toward the dependencies of its successors, so they may go
+    back to earlier tasks to form loops. A task only reached through weak 
+    edges is not a source of the graph and runs only when a condition task
+    selects it, so a loop is entered through a regular edge. A graph whose
+    condition tasks select none of its sinks still completes.
+    Condition tasks are not supported in subflows.
+
+    @tparam C callable type
+
+    @param callable a callable object returning @c int, which may be move-only
+
+    @return a Task handle
+    */
+    template <typename C>
+    Task condition(C&& callable);
     
     /**
     @brief adds a dependency link from task A to task B
@@ -266,9 +678,24 @@ class FlowBuilder {
     void gather(std::initializer_list<Task> others, Task A);
 
     bool empty() const { return _graph.empty(); }
+
+    /**
+    @brief queries the number of workers the parallel algorithms size their
+           partitions for
+
+    A taskflow reports the current number of workers of its executor, so
+    an algorithm created after the executor is resized is sized for the
+    new count. A zero means the builder does not know the executor that 
+    will run its graph, as for a tf::Framework. The algorithms then create 
+    a subflow task that partitions the range when it runs, for the number 
+    of workers of the executor running it.
+    */
+    virtual size_t parallelism() const { return _parallelism; }
     
   private:
 
+    size_t _parallelism {0};
+
     Graph& _graph;
 
     template <typename L>
@@ -276,10 +703,31 @@ class FlowBuilder {
 
     template <typename I>
     size_t _estimate_chunk_size(I, I, I);
+
+    template <typename L>
+    std::pair<Task, Task> _parallel_for(size_t, PartitionerType, size_t, L&&);
+
+    template <typename B>
+    std::pair<Task, Task> _defer(B&&);
+
+    template <typename I, typename O, typename T, typename B, typename U>
+    std::pair<Task, Task> _scan(I, I, O, std::optional<T>, B&&, U&&);
+
+    size_t _num_sort_blocks(size_t) const;
+
+    template <typename I, typename G, typename C>
+    std::pair<Task, Task> _sort(I, I, size_t, G&&, C&&);
+
+    template <typename S, typename C>
+    static size_t _split(S, size_t, size_t, size_t, size_t, C&);
+
+    template <typename O, typename C, typename S, typename P, size_t... I>
+    static void _dataflow(O*, C&, S&, P&, std::index_sequence<I...>);
 };
 
 // Constructor
-inline FlowBuilder::FlowBuilder(Graph& graph) :
+inline FlowBuilder::FlowBuilder(Graph& graph, size_t parallelism) :
+  _parallelism {parallelism},
   _graph {graph} {
 }
 
@@ -314,36 +762,209 @@ inline Task FlowBuilder::placeholder() {
   return Task(node);
 }
 
-// Function: parallel_for    
-template <typename I, typename C>
-std::pair<Task, Task> FlowBuilder::parallel_for(I beg, I end, C&& c, size_t g) {
+// Function: condition
+template <typename C>
+Task FlowBuilder::condition(C&& c) {
+  static_assert(std::is_invocable_r_v<int, C>, "condition work must return an index");
+  auto& n = _graph.emplace_back();
+  n._work.template emplace<Node::ConditionWork>(std::forward<C>(c));
+  return Task(n);
+}
 
-  using category = typename std::iterator_traits<I>::iterator_category;
-  
-  if(g == 0) {
-    auto d = std::distance(beg, end);
-    auto w = std::max(unsigned{1}, std::thread::hardware_concurrency());
-    g = (d + w - 1) / w;
+// Function: dataflow
+template <typename C, typename... Ts>
+auto FlowBuilder::dataflow(C&& c, const ValueTask<Ts>&... inputs) {
+
+  static_assert(
+    std::is_invocable_v<C, Ts&&...>, 
+    "the callable must take the values of the inputs"
+  );
+
+  using R = std::invoke_result_t<C, Ts&&...>;
+
+  if(((inputs._slot == nullptr) || ...)) {
+    TF_THROW(Error::FLOW_BUILDER, "an input of a dataflow task is empty");
   }
 
-  auto source = placeholder();
-  auto target = placeholder();
-  
-  while(beg != end) {
+  if(((!std::is_copy_constructible_v<Ts> && inputs.num_consumers() > 0) || ...)) {
+    TF_THROW(Error::FLOW_BUILDER, "a move-only value can be taken by one task only");
+  }
 
-    auto e = beg;
-    
-    // Case 1: random access iterator
-    if constexpr(std::is_same_v<category, std::random_access_iterator_tag>) {
-      size_t r = std::distance(beg, end);
-      std::advance(e, std::min(r, g));
-    }
-    // Case 2: non-random access iterator
-    else {
-      for(size_t i=0; i<g && e != end; ++e, ++i);
-    }
-      
-    // Create a task
+  (++inputs._slot->num_consumers, ...);
+
+  auto work = [
+    c=std::forward<C>(c), 
+    in=std::make_tuple(inputs._slot...), 
+    copies=std::tuple<std::optional<Ts>...>()
+  ] (auto out) mutable {
+    _dataflow(out, c, in, copies, std::index_sequence_for<Ts...>{});
+  };
+
+  if constexpr(std::is_void_v<R>) {
+    auto task = emplace([work=std::move(work)] () mutable { 
+      work(static_cast<void*>(nullptr)); 
+    });
+    task._node->set_dataflow();
+    (inputs._node->precede(*task._node), ...);
+    return task;
+  }
+  else {
+    auto slot = std::make_shared<typename ValueTask<R>::Slot>();
+    auto task = emplace([work=std::move(work), out=slot] () mutable { 
+      work(out.get()); 
+    });
+    task._node->set_dataflow();
+    (inputs._node->precede(*task._node), ...);
+    return ValueTask<R>(task, std::move(slot));
+  }
+}
+
+// Procedure: _dataflow
+// Invokes the callable on the values of the inputs and stores its result,
+// if any, before the inputs are released. The inputs are released as well
+// if the callable throws.
+template <typename O, typename C, typename S, typename P, size_t... I>
+void FlowBuilder::_dataflow(O* out, C& c, S& in, P& copies, std::index_sequence<I...>) {
+  try {
+    if constexpr(std::is_void_v<O>) {
+      std::invoke(c, std::get<I>(in)->take(std::get<I>(copies))...);
+    }
+    else {
+      out->store(std::invoke(c, std::get<I>(in)->take(std::get<I>(copies))...));
+    }
+  }
+  catch(...) {
+    (std::get<I>(in)->release(), ...);
+    (std::get<I>(copies).reset(), ...);
+    throw;
+  }
+  (std::get<I>(in)->release(), ...);
+  (std::get<I>(copies).reset(), ...);
+}
+
+// Function: produce
+template <typename T, typename G>
+Task FlowBuilder::produce(Channel<T>& ch, G&& g) {
+  auto& node = _graph.emplace_back();
+  node._work.template emplace<Node::StreamWork>(
+  [&ch, g=std::forward<G>(g)] (Node& n, const Waker& w) mutable {
+    while(true) {
+      if(w.is_cancelled()) {
+        ch._close();
+        return true;
+      }
+      if(ch._full()) {
+        if(ch._park(Channel<T>::PRODUCER, n, w, &Channel<T>::_full)) {
+          return false;
+        }
+        continue;
+      }
+      std::optional<T> item = g();
+      if(!item) {
+        ch._close();
+        return true;
+      }
+      ch._push(std::move(*item));
+    }
+  });
+  return Task(node);
+}
+
+// Function: consume
+template <typename T, typename C>
+Task FlowBuilder::consume(Channel<T>& ch, C&& c) {
+  auto& node = _graph.emplace_back();
+  node._work.template emplace<Node::StreamWork>(
+  [&ch, c=std::forward<C>(c)] (Node& n, const Waker& w) mutable {
+    while(true) {
+      if(auto item = ch._pop(); item) {
+        if(!w.is_cancelled()) {
+          c(std::move(*item));
+        }
+        continue;
+      }
+      if(ch._drained()) {
+        ch._reopen();
+        return true;
+      }
+      if(ch._park(Channel<T>::CONSUMER, n, w, &Channel<T>::_starved)) {
+        return false;
+      }
+    }
+  });
+  return Task(node);
+}
+
+// Function: transform
+// The task checks for room in the output before it takes an input item, so
+// it never holds an item while it is parked. A cancelled task drops its 
+// input items until the input stream ends.
+template <typename T, typename U, typename C>
+Task FlowBuilder::transform(Channel<T>& in, Channel<U>& out, C&& c) {
+  auto& node = _graph.emplace_back();
+  node._work.template emplace<Node::StreamWork>(
+  [&in, &out, c=std::forward<C>(c)] (Node& n, const Waker& w) mutable {
+    while(true) {
+      if(!w.is_cancelled() && out._full()) {
+        if(out._park(Channel<U>::PRODUCER, n, w, &Channel<U>::_full)) {
+          return false;
+        }
+        continue;
+      }
+      if(auto item = in._pop(); item) {
+        if(!w.is_cancelled()) {
+          out._push(U(c(std::move(*item))));
+        }
+        continue;
+      }
+      if(in._drained()) {
+        in._reopen();
+        out._close();
+        return true;
+      }
+      if(in._park(Channel<T>::CONSUMER, n, w, &Channel<T>::_starved)) {
+        return false;
+      }
+    }
+  });
+  return Task(node);
+}
+
+// Function: parallel_for    
+template <typename I, typename C>
+std::pair<Task, Task> FlowBuilder::parallel_for(I beg, I end, C&& c, size_t g) {
+
+  using category = typename std::iterator_traits<I>::iterator_category;
+  
+  if(g == 0) {
+    const size_t w = parallelism();
+    if(w == 0) {
+      return _defer([=, c=std::forward<C>(c)] (auto& sf) mutable {
+        sf.parallel_for(beg, end, c);
+      });
+    }
+    size_t d = std::distance(beg, end);
+    g = (d + w - 1) / w;
+  }
+
+  auto source = placeholder();
+  auto target = placeholder();
+  
+  while(beg != end) {
+
+    auto e = beg;
+    
+    // Case 1: random access iterator
+    if constexpr(std::is_same_v<category, std::random_access_iterator_tag>) {
+      size_t r = std::distance(beg, end);
+      std::advance(e, std::min(r, g));
+    }
+    // Case 2: non-random access iterator
+    else {
+      for(size_t i=0; i<g && e != end; ++e, ++i);
+    }
+      
+    // Create a task
     auto task = emplace([beg, e, c] () mutable {
       std::for_each(beg, e, c);
     });
@@ -372,6 +993,12 @@ std::pair<Task, Task> FlowBuilder::parallel_for(I beg, I end, I s, C&& c, size_t
       "invalid range [", beg, ", ", end, ") with step size ", s
     );
   }
+
+  if(g == 0 && parallelism() == 0) {
+    return _defer([=, c=std::forward<C>(c)] (auto& sf) mutable {
+      sf.parallel_for(beg, end, s, c);
+    });
+  }
     
   auto source = placeholder();
   auto target = placeholder();
@@ -451,6 +1078,194 @@ std::pair<Task, Task> FlowBuilder::parallel_for(I beg, I end, I s, C&& c, size_t
   return std::make_pair(source, target); 
 }
 
+// Function: parallel_for
+template <typename I, typename C>
+std::pair<Task, Task> FlowBuilder::parallel_for(
+  I beg, I end, C&& c, const Partitioner& p
+) {
+
+  using category = typename std::iterator_traits<I>::iterator_category;
+
+  if(p.type() == PartitionerType::STATIC) {
+    return parallel_for(beg, end, std::forward<C>(c), p.chunk());
+  }
+
+  // Case 1: random access iterator
+  if constexpr(std::is_same_v<category, std::random_access_iterator_tag>) {
+    return _parallel_for(std::distance(beg, end), p.type(), p.chunk(),
+      [beg, c=std::forward<C>(c)] (size_t b, size_t e) mutable {
+        for(auto i=beg+b; i!=beg+e; ++i) {
+          c(*i);
+        }
+      }
+    );
+  }
+  // Case 2: non-random access iterator
+  // The range is cut into units of the chunk size when the graph is built,
+  // and the partitioner hands out the units.
+  else {
+    const size_t g = std::max(size_t{1}, p.chunk());
+    auto units = std::make_shared<std::vector<I>>(1, beg);
+    while(beg != end) {
+      for(size_t i=0; i<g && beg != end; ++beg, ++i);
+      units->push_back(beg);
+    }
+    const size_t N = units->size() - 1;
+    return _parallel_for(N, p.type(), p.type() == PartitionerType::AUTO ? 0 : 1,
+      [units, c=std::forward<C>(c)] (size_t b, size_t e) mutable {
+        for(auto i=(*units)[b]; i!=(*units)[e]; ++i) {
+          c(*i);
+        }
+      }
+    );
+  }
+}
+
+// Function: parallel_for
+template <
+  typename I, 
+  typename C, 
+  std::enable_if_t<std::is_arithmetic_v<I>, void>*
+>
+std::pair<Task, Task> FlowBuilder::parallel_for(
+  I beg, I end, I s, C&& c, const Partitioner& p
+) {
+
+  using T = std::decay_t<I>;
+
+  if(p.type() == PartitionerType::STATIC) {
+    return parallel_for(beg, end, s, std::forward<C>(c), p.chunk());
+  }
+
+  if((s == 0) || (beg < end && s <= 0) || (beg > end && s >=0) ) {
+    TF_THROW(Error::FLOW_BUILDER, 
+      "invalid range [", beg, ", ", end, ") with step size ", s
+    );
+  }
+
+  size_t N = 0;
+
+  if constexpr(std::is_integral_v<T>) {
+    if(beg < end) {
+      N = static_cast<size_t>((end - beg + s - 1) / s);
+    }
+    else if(beg > end) {
+      N = static_cast<size_t>((end - beg + s + 1) / s);
+    }
+  }
+  // We enumerate the entire sequence to avoid floating error
+  else {
+    for(auto i=beg; (beg<end ? i<end : i>end); i+=s, ++N);
+  }
+
+  return _parallel_for(N, p.type(), p.chunk(),
+    [beg, s, c=std::forward<C>(c)] (size_t b, size_t e) mutable {
+      auto i = static_cast<T>(beg + static_cast<T>(b) * s);
+      for(size_t k=b; k<e; ++k, i+=s) {
+        c(i);
+      }
+    }
+  );
+}
+
+// Function: _parallel_for
+// Creates one task per worker, each calling the loop on chunks 
+// [b, e) of the indices [0, N) it takes at run time. Dynamic and guided
+// tasks share a single cursor; under the auto policy each task has a cursor
+// over its own block and moves on to the blocks of the next tasks when its
+// block is done. The source task resets the cursors for every run.
+template <typename L>
+std::pair<Task, Task> FlowBuilder::_parallel_for(
+  size_t N, PartitionerType type, size_t g, L&& loop
+) {
+
+  struct alignas(64) Cursor {
+    std::atomic<size_t> value;
+  };
+
+  const size_t W = parallelism();
+
+  if(W == 0) {
+    return _defer([=, loop=std::forward<L>(loop)] (auto& sf) mutable {
+      sf._parallel_for(N, type, g, loop);
+    });
+  }
+
+  if(g == 0) {
+    g = type == PartitionerType::AUTO ? std::max(size_t{1}, N / (8 * W)) : 1;
+  }
+
+  const size_t T = std::min(W, (N + g - 1) / g);
+
+  if(T == 0) {
+    return std::make_pair(placeholder(), placeholder());
+  }
+
+  auto cursors = std::make_shared<std::vector<Cursor>>(
+    type == PartitionerType::AUTO ? T : 1
+  );
+
+  auto source = emplace([cursors, type, N, T] () {
+    auto& cs = *cursors;
+    for(size_t t=0; t<cs.size(); ++t) {
+      cs[t].value.store(
+        type == PartitionerType::AUTO ? t * N / T : 0, std::memory_order_relaxed
+      );
+    }
+  });
+  
+  auto target = placeholder();
+
+  for(size_t t=0; t<T; ++t) {
+
+    auto task = emplace([cursors, loop, type, N, T, g, t] () mutable {
+
+      auto& cs = *cursors;
+
+      switch(type) {
+
+        case PartitionerType::GUIDED: {
+          auto& cursor = cs[0].value;
+          size_t b = cursor.load(std::memory_order_relaxed);
+          while(b < N) {
+            size_t e = std::min(N, b + std::max(g, (N - b) / (2 * T)));
+            if(cursor.compare_exchange_weak(b, e, std::memory_order_relaxed)) {
+              loop(b, e);
+              b = cursor.load(std::memory_order_relaxed);
+            }
+          }
+        }
+        break;
+
+        case PartitionerType::AUTO: {
+          for(size_t k=0; k<T; ++k) {
+            const size_t j = (t + k) % T;
+            const size_t e = (j + 1) * N / T;
+            size_t b;
+            while((b = cs[j].value.fetch_add(g, std::memory_order_relaxed)) < e) {
+              loop(b, std::min(b + g, e));
+            }
+          }
+        }
+        break;
+
+        default: {
+          size_t b;
+          while((b = cs[0].value.fetch_add(g, std::memory_order_relaxed)) < N) {
+            loop(b, std::min(b + g, N));
+          }
+        }
+        break;
+      }
+    });
+
+    source.precede(task);
+    task.precede(target);
+  }
+  
+  return std::make_pair(source, target);
+}
+
 // Function: reduce_min
 // Find the minimum element over a range of items.
 template <typename I, typename T>
@@ -474,10 +1289,18 @@ template <typename I, typename T, typename B, typename U>
 std::pair<Task, Task> FlowBuilder::transform_reduce(I beg, I end, T& result, B&& bop, U&& uop) {
 
   using category = typename std::iterator_traits<I>::iterator_category;
+
+  const size_t w = parallelism();
+
+  if(w == 0) {
+    return _defer([=, &result, bop=std::forward<B>(bop), uop=std::forward<U>(uop)] 
+    (auto& sf) mutable {
+      sf.transform_reduce(beg, end, result, bop, uop);
+    });
+  }
   
   // Even partition
   size_t d = std::distance(beg, end);
-  size_t w = std::max(unsigned{1}, std::thread::hardware_concurrency());
   size_t g = std::max((d + w - 1) / w, size_t{2});
 
   auto source = placeholder();
@@ -518,9 +1341,9 @@ std::pair<Task, Task> FlowBuilder::transform_reduce(I beg, I end, T& result, B&&
   }
 
   // target synchronizer 
-  target.work([&result, bop, res=MoC{std::move(g_results)}, w=id] () {
+  target.work([&result, bop, res=std::move(g_results), w=id] () {
     for(auto i=0u; i<w; i++) {
-      result = bop(std::move(result), res.object[i]);
+      result = bop(std::move(result), res[i]);
     }
   });
 
@@ -534,10 +1357,18 @@ std::pair<Task, Task> FlowBuilder::transform_reduce(
 ) {
 
   using category = typename std::iterator_traits<I>::iterator_category;
+
+  const size_t w = parallelism();
+
+  if(w == 0) {
+    return _defer([=, &result, bop=std::forward<B>(bop), pop=std::forward<P>(pop),
+                   uop=std::forward<U>(uop)] (auto& sf) mutable {
+      sf.transform_reduce(beg, end, result, bop, pop, uop);
+    });
+  }
   
   // Even partition
   size_t d = std::distance(beg, end);
-  size_t w = std::max(unsigned{1}, std::thread::hardware_concurrency());
   size_t g = std::max((d + w - 1) / w, size_t{2});
 
   auto source = placeholder();
@@ -584,9 +1415,9 @@ std::pair<Task, Task> FlowBuilder::transform_reduce(
   }
 
   // target synchronizer 
-  target.work([&result, bop, g_results=MoC{std::move(g_results)}, w=id] () {
+  target.work([&result, bop, g_results=std::move(g_results), w=id] () mutable {
     for(auto i=0u; i<w; i++) {
-      result = bop(std::move(result), std::move(g_results.object[i]));
+      result = bop(std::move(result), std::move(g_results[i]));
     }
   });
   //target.work([&result, futures=MoC{std::move(futures)}, bop] () {
@@ -604,7 +1435,7 @@ size_t FlowBuilder::_estimate_chunk_size(I beg, I end, I step) {
 
   using T = std::decay_t<I>;
       
-  size_t w = std::max(unsigned{1}, std::thread::hardware_concurrency());
+  size_t w = parallelism();
   size_t N = 0;
 
   if constexpr(std::is_integral_v<T>) {
@@ -626,6 +1457,485 @@ size_t FlowBuilder::_estimate_chunk_size(I beg, I end, I step) {
 }
 
 
+// Function: parallel_for
+template <typename R, typename C>
+std::pair<Task, Task> FlowBuilder::parallel_for(
+  std::reference_wrapper<R> r, C&& c, size_t g
+) {
+  return _defer([r, g, c=std::forward<C>(c)] (auto& sf) mutable {
+    sf.parallel_for(std::begin(r.get()), std::end(r.get()), c, g);
+  });
+}
+
+// Function: parallel_for
+template <typename R, typename C>
+std::pair<Task, Task> FlowBuilder::parallel_for(
+  std::reference_wrapper<R> r, C&& c, const Partitioner& p
+) {
+  return _defer([r, p, c=std::forward<C>(c)] (auto& sf) mutable {
+    sf.parallel_for(std::begin(r.get()), std::end(r.get()), c, p);
+  });
+}
+
+// Function: parallel_for
+template <
+  typename I, 
+  typename J, 
+  typename C, 
+  std::enable_if_t<std::is_arithmetic_v<std::remove_cv_t<I>>, void>*
+>
+std::pair<Task, Task> FlowBuilder::parallel_for(
+  std::reference_wrapper<I> beg, std::reference_wrapper<J> end, 
+  std::remove_cv_t<I> s, C&& c, size_t g
+) {
+
+  if(s == 0) {
+    TF_THROW(Error::FLOW_BUILDER, "invalid step size ", s);
+  }
+
+  return _defer([beg, end, s, g, c=std::forward<C>(c)] (auto& sf) mutable {
+    std::remove_cv_t<I> b = beg.get(), e = end.get();
+    if((b < e && s < 0) || (b > e && s > 0)) {
+      return;
+    }
+    sf.parallel_for(b, e, s, c, g);
+  });
+}
+
+// Function: reduce
+template <typename R, typename T, typename B>
+std::pair<Task, Task> FlowBuilder::reduce(std::reference_wrapper<R> r, T& result, B&& bop) {
+  return _defer([r, &result, bop=std::forward<B>(bop)] (auto& sf) mutable {
+    sf.reduce(std::begin(r.get()), std::end(r.get()), result, bop);
+  });
+}
+
+// Function: reduce_min
+template <typename R, typename T>
+std::pair<Task, Task> FlowBuilder::reduce_min(std::reference_wrapper<R> range, T& result) {
+  return reduce(range, result, [] (const auto& l, const auto& r) {
+    return std::min(l, r);
+  });
+}
+
+// Function: reduce_max
+template <typename R, typename T>
+std::pair<Task, Task> FlowBuilder::reduce_max(std::reference_wrapper<R> range, T& result) {
+  return reduce(range, result, [] (const auto& l, const auto& r) {
+    return std::max(l, r);
+  });
+}
+
+// Function: transform_reduce
+template <typename R, typename T, typename B, typename U>
+std::pair<Task, Task> FlowBuilder::transform_reduce(
+  std::reference_wrapper<R> r, T& result, B&& bop, U&& uop
+) {
+  return _defer([r, &result, bop=std::forward<B>(bop), uop=std::forward<U>(uop)] 
+  (auto& sf) mutable {
+    sf.transform_reduce(std::begin(r.get()), std::end(r.get()), result, bop, uop);
+  });
+}
+
+// Function: transform_reduce
+template <typename R, typename T, typename B, typename P, typename U>
+std::pair<Task, Task> FlowBuilder::transform_reduce(
+  std::reference_wrapper<R> r, T& result, B&& bop, P&& pop, U&& uop
+) {
+  return _defer([r, &result, bop=std::forward<B>(bop), pop=std::forward<P>(pop),
+                 uop=std::forward<U>(uop)] (auto& sf) mutable {
+    sf.transform_reduce(std::begin(r.get()), std::end(r.get()), result, bop, pop, uop);
+  });
+}
+
+// Function: inclusive_scan
+template <typename I, typename O, typename B>
+std::pair<Task, Task> FlowBuilder::inclusive_scan(I beg, I end, O out, B&& bop) {
+  using T = typename std::iterator_traits<I>::value_type;
+  return _scan(beg, end, out, std::optional<T>{}, std::forward<B>(bop), 
+    [] (const auto& v) -> const auto& { return v; }
+  );
+}
+
+// Function: exclusive_scan
+template <typename I, typename O, typename T, typename B>
+std::pair<Task, Task> FlowBuilder::exclusive_scan(I beg, I end, O out, T init, B&& bop) {
+  return _scan(beg, end, out, std::optional<T>{std::move(init)}, std::forward<B>(bop),
+    [] (const auto& v) -> const auto& { return v; }
+  );
+}
+
+// Function: transform_inclusive_scan
+template <typename I, typename O, typename B, typename U>
+std::pair<Task, Task> FlowBuilder::transform_inclusive_scan(
+  I beg, I end, O out, B&& bop, U&& uop
+) {
+  using T = std::decay_t<std::invoke_result_t<U&, decltype(*beg)>>;
+  return _scan(beg, end, out, std::optional<T>{}, std::forward<B>(bop), std::forward<U>(uop));
+}
+
+// Function: transform_exclusive_scan
+template <typename I, typename O, typename T, typename B, typename U>
+std::pair<Task, Task> FlowBuilder::transform_exclusive_scan(
+  I beg, I end, O out, T init, B&& bop, U&& uop
+) {
+  return _scan(beg, end, out, std::optional<T>{std::move(init)}, 
+    std::forward<B>(bop), std::forward<U>(uop)
+  );
+}
+
+// Function: _scan
+// Two-pass blocked scan over one contiguous block per worker, exclusive if 
+// an initial value is given. The first block is scanned right away and 
+// leaves its reduction; the middle blocks are only reduced in the first 
+// pass. A serial task then scans the block reductions into the carry of 
+// each block, and the second pass scans the other blocks from their carry.
+template <typename I, typename O, typename T, typename B, typename U>
+std::pair<Task, Task> FlowBuilder::_scan(
+  I beg, I end, O out, std::optional<T> init, B&& bop, U&& uop
+) {
+
+  using category = typename std::iterator_traits<I>::iterator_category;
+
+  const size_t w = parallelism();
+
+  if(w == 0) {
+    return _defer([=, bop=std::forward<B>(bop), uop=std::forward<U>(uop)] 
+    (auto& sf) mutable {
+      sf._scan(beg, end, out, init, bop, uop);
+    });
+  }
+
+  size_t d = std::distance(beg, end);
+  size_t g = std::max((d + w - 1) / w, size_t{1});
+
+  auto source = placeholder();
+  auto target = placeholder();
+
+  if(d == 0) {
+    return std::make_pair(source, target);
+  }
+
+  const size_t K = (d + g - 1) / g;
+
+  auto sums = std::make_unique<T[]>(K);
+  auto s = sums.get();
+
+  // The serial scan of the block reductions owns their storage.
+  auto carry = emplace([s, K, bop, sums=std::move(sums)] () mutable {
+    for(size_t k=1; k+1<K; ++k) {
+      s[k] = bop(s[k-1], s[k]);
+    }
+  });
+
+  for(size_t k=0; k<K; ++k) {
+
+    auto e = beg;
+    auto o = out;
+    
+    // Case 1: random access iterator
+    if constexpr(std::is_same_v<category, std::random_access_iterator_tag>) {
+      size_t n = std::min(size_t(std::distance(beg, end)), g);
+      std::advance(e, n);
+      std::advance(o, n);
+    }
+    // Case 2: non-random access iterator
+    else {
+      for(size_t i=0; i<g && e != end; ++e, ++o, ++i);
+    }
+
+    // first pass: reduce a middle block
+    if(k != 0 && k + 1 != K) {
+      auto task = emplace([beg, e, res=&s[k], bop, uop] () mutable {
+        T acc = uop(*beg);
+        for(++beg; beg != e; ++beg) {
+          acc = bop(std::move(acc), uop(*beg));
+        }
+        *res = std::move(acc);
+      });
+      source.precede(task);
+      task.precede(carry);
+    }
+    
+    // second pass: scan the block from its carry
+    auto task = emplace([beg, e, out, k, K, s, init, bop, uop] () mutable {
+      std::optional<T> acc;
+      if(init) {
+        acc.emplace(k == 0 ? *init : s[k-1]);
+        for(; beg != e; ++beg, ++out) {
+          T v = uop(*beg);
+          *out = *acc;
+          acc = bop(std::move(*acc), std::move(v));
+        }
+      }
+      else {
+        acc.emplace(k == 0 ? T(uop(*beg)) : T(bop(s[k-1], uop(*beg))));
+        for(*out = *acc, ++beg, ++out; beg != e; ++beg, ++out) {
+          acc = bop(std::move(*acc), uop(*beg));
+          *out = *acc;
+        }
+      }
+      if(k == 0 && K > 1) {
+        s[0] = std::move(*acc);
+      }
+    });
+
+    if(k == 0) {
+      source.precede(task);
+      task.precede(carry);
+    }
+    else {
+      carry.precede(task);
+    }
+    task.precede(target);
+
+    beg = e;
+    out = o;
+  }
+
+  if(K == 1) {
+    source.precede(carry);
+    carry.precede(target);
+  }
+
+  return std::make_pair(source, target);
+}
+
+// Function: sort
+template <typename I, typename C>
+std::pair<Task, Task> FlowBuilder::sort(I beg, I end, C&& cmp) {
+
+  using T = typename std::iterator_traits<I>::value_type;
+
+  if(parallelism() == 0) {
+    return _defer([beg, end, cmp=std::forward<C>(cmp)] (auto& sf) mutable {
+      sf.sort(beg, end, cmp);
+    });
+  }
+
+  const size_t N = std::distance(beg, end);
+  const size_t K = _num_sort_blocks(N);
+
+  auto buffer = std::make_shared<std::vector<T>>();
+
+  auto [source, target] = _sort(beg, end, K, [buffer] () { return buffer->begin(); },
+    std::forward<C>(cmp)
+  );
+
+  if(K > 1) {
+    source.work([buffer, N] () { buffer->resize(N); });
+    target.work([buffer] () { std::vector<T>().swap(*buffer); });
+  }
+
+  return std::make_pair(source, target);
+}
+
+// Function: sort
+template <typename I>
+std::pair<Task, Task> FlowBuilder::sort(I beg, I end) {
+  return sort(beg, end, std::less<typename std::iterator_traits<I>::value_type>());
+}
+
+// Function: sort
+template <typename I, typename S, typename C>
+std::pair<Task, Task> FlowBuilder::sort(I beg, I end, S scratch, C&& cmp) {
+
+  if(parallelism() == 0) {
+    return _defer([beg, end, scratch, cmp=std::forward<C>(cmp)] (auto& sf) mutable {
+      sf.sort(beg, end, scratch, cmp);
+    });
+  }
+
+  return _sort(beg, end, _num_sort_blocks(std::distance(beg, end)), 
+    [scratch] () { return scratch; }, std::forward<C>(cmp)
+  );
+}
+
+// Function: _num_sort_blocks
+// Blocks of fewer items than the cutoff are not worth a task of their own.
+inline size_t FlowBuilder::_num_sort_blocks(size_t N) const {
+  constexpr size_t cutoff = 2048;
+  return std::max(size_t{1}, std::min(parallelism(), N / cutoff));
+}
+
+// Function: _sort
+// Sorts the blocks and merges pairs of adjacent sorted runs in rounds, 
+// moving the items back and forth between the range and the scratch buffer
+// returned by the getter. A round splits the merge of a pair into as many
+// pieces as the pair has blocks, each covering an equal share of the 
+// output. A task first finds where all pieces split the two runs, since 
+// the pieces move items out of the runs, and a placeholder joins the
+// pieces for the next round. An odd run is moved over as a merge with an
+// empty run. If the rounds end in the scratch buffer, a last round moves
+// the items back. The caller counts the K blocks once, since the number of
+// workers may change while the graph is built.
+template <typename I, typename G, typename C>
+std::pair<Task, Task> FlowBuilder::_sort(I beg, I end, size_t K, G&& scratch, C&& cmp) {
+
+  const size_t N = std::distance(beg, end);
+
+  auto source = placeholder();
+  auto target = placeholder();
+
+  if(N < 2) {
+    return std::make_pair(source, target);
+  }
+
+  if(K == 1) {
+    auto task = emplace([beg, end, cmp] () mutable {
+      std::sort(beg, end, cmp);
+    });
+    source.precede(task);
+    task.precede(target);
+    return std::make_pair(source, target);
+  }
+
+  std::vector<size_t> bounds(K+1);
+  for(size_t k=0; k<=K; ++k) {
+    bounds[k] = k * N / K;
+  }
+
+  // sorted runs as ranges of blocks and the tasks after which they are ready
+  std::vector<std::pair<size_t, size_t>> runs;
+  std::vector<Task> ready;
+
+  for(size_t k=0; k<K; ++k) {
+    auto task = emplace([b=beg+bounds[k], e=beg+bounds[k+1], cmp] () mutable {
+      std::sort(b, e, cmp);
+    });
+    source.precede(task);
+    runs.emplace_back(k, k+1);
+    ready.push_back(task);
+  }
+
+  bool in_scratch = false;
+
+  while(runs.size() > 1) {
+
+    std::vector<std::pair<size_t, size_t>> next_runs;
+    std::vector<Task> next_ready;
+
+    for(size_t r=0; r<runs.size(); r+=2) {
+
+      const size_t lb = runs[r].first;
+      const size_t lm = runs[r].second;
+      const size_t le = r + 1 < runs.size() ? runs[r+1].second : lm;
+      const size_t a0 = bounds[lb], a1 = bounds[lm], a2 = bounds[le];
+      const size_t m = le - lb;
+
+      // the number of items of the first run in the output of each piece
+      auto splits = std::make_shared<std::vector<size_t>>(m+1);
+
+      auto split = emplace([beg, scratch, in_scratch, a0, a1, a2, m, splits, cmp] () mutable {
+        auto& i = *splits;
+        for(size_t j=0; j<=m; ++j) {
+          const size_t d = j * (a2 - a0) / m;
+          i[j] = in_scratch ? _split(scratch(), a0, a1, a2, d, cmp) :
+                              _split(beg, a0, a1, a2, d, cmp);
+        }
+      });
+
+      ready[r].precede(split);
+      if(r + 1 < runs.size()) {
+        ready[r+1].precede(split);
+      }
+
+      auto join = placeholder();
+
+      for(size_t j=0; j<m; ++j) {
+        auto task = emplace([beg, scratch, in_scratch, a0, a1, a2, j, m, splits, cmp] () mutable {
+          const size_t d0 = j * (a2 - a0) / m;
+          const size_t d1 = (j + 1) * (a2 - a0) / m;
+          const size_t i0 = (*splits)[j];
+          const size_t i1 = (*splits)[j+1];
+          auto merge = [&] (auto src, auto dst) {
+            std::merge(
+              std::make_move_iterator(src + (a0 + i0)), 
+              std::make_move_iterator(src + (a0 + i1)),
+              std::make_move_iterator(src + (a1 + d0 - i0)), 
+              std::make_move_iterator(src + (a1 + d1 - i1)),
+              dst + (a0 + d0), cmp
+            );
+          };
+          if(in_scratch) {
+            merge(scratch(), beg);
+          }
+          else {
+            merge(beg, scratch());
+          }
+        });
+        split.precede(task);
+        task.precede(join);
+      }
+
+      next_runs.emplace_back(lb, le);
+      next_ready.push_back(join);
+    }
+
+    runs = std::move(next_runs);
+    ready = std::move(next_ready);
+    in_scratch = !in_scratch;
+  }
+
+  if(in_scratch) {
+    for(size_t k=0; k<K; ++k) {
+      auto task = emplace([beg, scratch, b=bounds[k], e=bounds[k+1]] () mutable {
+        auto s = scratch();
+        std::move(s + b, s + e, beg + b);
+      });
+      ready[0].precede(task);
+      task.precede(target);
+    }
+  }
+  else {
+    ready[0].precede(target);
+  }
+
+  return std::make_pair(source, target);
+}
+
+// Function: _split
+// Finds how many items of the sorted run [a0, a1) of the source are among
+// the first d items of its stable merge with the sorted run [a1, a2), by
+// binary search; items of the first run go first on ties.
+template <typename S, typename C>
+size_t FlowBuilder::_split(S src, size_t a0, size_t a1, size_t a2, size_t d, C& cmp) {
+
+  const auto A = src + a0;
+  const auto B = src + a1;
+  const size_t a = a1 - a0;
+  const size_t b = a2 - a1;
+
+  size_t lo = d > b ? d - b : 0;
+  size_t hi = std::min(d, a);
+
+  while(lo < hi) {
+    size_t mid = (lo + hi) / 2;
+    if(!cmp(B[d-mid-1], A[mid])) {
+      lo = mid + 1;
+    }
+    else {
+      hi = mid;
+    }
+  }
+
+  return lo;
+}
+
+// Function: _defer
+// Creates a subflow task between a source and a target task that builds an
+// algorithm when it runs. The subflow is sized for the workers of the 
+// executor running it, and is built again on every run.
+template <typename B>
+std::pair<Task, Task> FlowBuilder::_defer(B&& build) {
+  auto source = placeholder();
+  auto target = placeholder();
+  auto task = emplace(std::forward<B>(build));
+  source.precede(task);
+  task.precede(target);
+  return std::make_pair(source, target);
+}
+
 // Procedure: _linearize
 template <typename L>
 void FlowBuilder::_linearize(L& keys) {
@@ -659,9 +1969,16 @@ template <typename I, typename T, typename B>
 std::pair<Task, Task> FlowBuilder::reduce(I beg, I end, T& result, B&& op) {
   
   using category = typename std::iterator_traits<I>::iterator_category;
+
+  const size_t w = parallelism();
+
+  if(w == 0) {
+    return _defer([=, &result, op=std::forward<B>(op)] (auto& sf) mutable {
+      sf.reduce(beg, end, result, op);
+    });
+  }
   
   size_t d = std::distance(beg, end);
-  size_t w = std::max(unsigned{1}, std::thread::hardware_concurrency());
   size_t g = std::max((d + w - 1) / w, size_t{2});
 
   auto source = placeholder();
@@ -714,9 +2031,9 @@ std::pair<Task, Task> FlowBuilder::reduce(I beg, I end, T& result, B&& op) {
   //    result = op(std::move(result), fu.get());
   //  }
   //});
-  target.work([g_results=MoC{std::move(g_results)}, &result, op, w=id] () {
+  target.work([g_results=std::move(g_results), &result, op, w=id] () {
     for(auto i=0u; i<w; i++) {
-      result = op(std::move(result), g_results.object[i]);
+      result = op(std::move(result), g_results[i]);
     }
   });
 
@@ -815,7 +2132,8 @@ Task FlowBuilder::emplace(C&& c) {
   }
   // static tasking
   else if constexpr(std::is_invocable_v<C>) {
-    auto& n = _graph.emplace_back(std::forward<C>(c));
+    auto& n = _graph.emplace_back();
+    n._work.template emplace<Node::StaticWork>(std::forward<C>(c));
     return Task(n);
   }
   else {
@@ -6,6 +6,118 @@ namespace tf {
 
 class WorkGroup;
 
+// Class: Plan
+// An immutable compressed-sparse-row (CSR) snapshot of a framework graph.
+// Node i releases the nodes at _successors[_offsets[i].._offsets[i+1]), and
+// its join counter lives in a flat array instead of its own node, so 
+// repeated runs decrement densely packed counters rather than chasing
+// successor pointers into the nodes. The edges of condition tasks are not
+// counted in the joins.
+class Plan {
+
+  template <template<typename...> typename E> 
+  friend class BasicTaskflow;
+
+  friend class Framework;
+  friend class Topology;
+  friend class Window;
+
+  public:
+
+    Plan(Graph&);
+
+  private:
+
+    std::vector<Node*> _nodes;
+    std::vector<unsigned> _offsets;
+    std::vector<unsigned> _successors;
+    std::vector<int> _joins;
+    std::unique_ptr<std::atomic<int>[]> _counters;
+
+    std::vector<Node*> _sources;
+    int _num_sinks {0};
+
+    // The condition tasks, whose edges are not joined, if there are any.
+    std::vector<bool> _conditions;
+    bool _branched {false};
+
+    // Iterations cannot overlap with condition tasks, nor with dataflow 
+    // tasks, which keep one value per task.
+    bool _serial {false};
+
+    bool _matches(const Graph&) const;
+    void _reset();
+};
+
+// Constructor
+inline Plan::Plan(Graph& g) {
+
+  _nodes.reserve(g.size());
+  _offsets.reserve(g.size() + 1);
+
+  for(auto& node : g) {
+    node._index = static_cast<unsigned>(_nodes.size());
+    _nodes.push_back(&node);
+  }
+
+  _joins.resize(_nodes.size(), 0);
+  _offsets.push_back(0);
+
+  for(auto node : _nodes) {
+    _conditions.push_back(node->is_condition());
+    if(node->is_condition()) {
+      _branched = true;
+    }
+    if(node->is_condition() || node->is_dataflow()) {
+      _serial = true;
+    }
+    for(auto s : node->_successors) {
+      _successors.push_back(s->_index);
+      if(!node->is_condition()) {
+        ++_joins[s->_index];
+      }
+    }
+    _offsets.push_back(static_cast<unsigned>(_successors.size()));
+    if(node->num_dependents() == 0) {
+      _sources.push_back(node);
+    }
+    if(node->num_successors() == 0) {
+      ++_num_sinks;
+    }
+  }
+
+  _counters = std::make_unique<std::atomic<int>[]>(_nodes.size());
+  _reset();
+}
+
+// Function: _matches
+// Queries if the graph is still the one this plan was built from. Tasks and
+// edges can only be added to a framework, so equal counts mean no change,
+// unless the work of a task has been changed to or from a condition.
+inline bool Plan::_matches(const Graph& g) const {
+  if(g.size() != _nodes.size()) {
+    return false;
+  }
+  for(size_t i=0; i<_nodes.size(); ++i) {
+    if(_nodes[i]->num_successors() != _offsets[i+1] - _offsets[i] ||
+       _nodes[i]->is_condition() != _conditions[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Procedure: _reset
+// Restores all join counters from the initial join counts. During a run, 
+// the task that releases a node restores its counter for the next run.
+inline void Plan::_reset() {
+  for(size_t i=0; i<_joins.size(); ++i) {
+    _counters[i].store(_joins[i], std::memory_order_relaxed);
+  }
+}
+
+// ----------------------------------------------------------------------------
+
 /**
 @class Framework 
 
@@ -53,6 +165,39 @@ class Framework : public FlowBuilder {
     */
     size_t num_nodes() const;
 
+    /**
+    @brief compiles the framework into an immutable execution plan
+
+    The plan stores the task dependency graph in a compressed-sparse-row
+    layout that repeated runs (e.g., run_n and run_until) execute from. 
+    The first run freezes the framework implicitly and a run after tasks 
+    or dependencies have been added re-compiles it, so calling this method
+    only moves the compilation cost ahead of the first run. 
+    It must not be called while the framework is running.
+    */
+    void freeze();
+
+    /**
+    @brief sets the number of iterations of a repeated run that may overlap
+
+    With an overlap of W, a task of iteration k+1 of run_n or run_until
+    starts as soon as the task itself has finished iteration k and its
+    predecessors have finished iteration k+1, rather than after the whole
+    iteration k has finished. At most W iterations are in flight, and the
+    predicate of run_until is evaluated each time an iteration is admitted.
+    The default overlap is one, i.e., iterations do not overlap.
+    A framework with condition tasks or dataflow tasks runs its iterations
+    one at a time regardless of the overlap.
+
+    @param W the maximum number of iterations in flight
+    */
+    Framework& overlap(size_t W);
+
+    /**
+    @brief queries the number of iterations of a repeated run that may overlap
+    */
+    size_t overlap() const;
+
     auto& name(const std::string&) ;
 
     const std::string& name() const ;
@@ -65,6 +210,12 @@ class Framework : public FlowBuilder {
 
     std::mutex _mtx;
     std::list<Topology*> _topologies;
+
+    std::unique_ptr<Plan> _plan;
+
+    size_t _overlap {1};
+
+    Plan& _frozen_plan();
 };
 
 // Constructor
@@ -94,6 +245,31 @@ inline size_t Framework::num_nodes() const {
   return _graph.size();
 }
 
+// Procedure: freeze
+inline void Framework::freeze() {
+  _plan = std::make_unique<Plan>(_graph);
+}
+
+// Function: overlap
+inline Framework& Framework::overlap(size_t W) {
+  _overlap = std::max(W, size_t{1});
+  return *this;
+}
+
+// Function: overlap
+inline size_t Framework::overlap() const {
+  return _overlap;
+}
+
+// Function: _frozen_plan
+// Returns the execution plan, re-compiling it if the graph has changed.
+inline Plan& Framework::_frozen_plan() {
+  if(!_plan || !_plan->_matches(_graph)) {
+    freeze();
+  }
+  return *_plan;
+}
+
 // Procedure: dump
 inline void Framework::dump(std::ostream& os) const {
   os << "digraph " << _name << " Framework {\n";
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "graph.hpp"
+
+namespace tf {
+
+/**
+@class Future
+
+@brief The handle to a run of a task dependency graph.
+
+A future is a std::shared_future<void> that can also cancel the run it
+refers to. It is returned by tf::BasicTaskflow::dispatch and the run methods
+of tf::BasicTaskflow, and converts to std::shared_future<void> where one
+is expected.
+
+If a task throws, the first exception is kept, the rest of the run is 
+cancelled, and @c get rethrows the exception once the run completes.
+
+@code{.cpp}
+tf::Future future = taskflow.run_n(framework, 100);
+if(future.wait_for(std::chrono::seconds(1)) == std::future_status::timeout) {
+  future.cancel();
+}
+future.get();
+@endcode
+*/
+class Future : public std::shared_future<void> {
+
+  template <template<typename...> typename E>
+  friend class BasicTaskflow;
+
+  public:
+
+    /**
+    @brief constructs a future that refers to no run
+    */
+    Future() = default;
+
+    /**
+    @brief requests the run to stop
+
+    Tasks that have not started are skipped, tasks being run finish, and no
+    further iteration of a framework or token of a pipeline is started. The
+    future becomes ready once the tasks being run finish. The graph is left
+    ready for the next run, but the results of the skipped tasks are never
+    produced.
+
+    @return @c true if the run had not completed when it was cancelled
+    */
+    bool cancel();
+
+    /**
+    @brief queries if the run has been cancelled, by this method or by an
+           exception of a task
+    */
+    bool is_cancelled() const;
+
+  private:
+
+    Future(std::shared_future<void>, std::shared_ptr<std::atomic<bool>> = nullptr);
+
+    std::shared_ptr<std::atomic<bool>> _cancelled;
+};
+
+// Constructor
+inline Future::Future(
+  std::shared_future<void> future, std::shared_ptr<std::atomic<bool>> cancelled
+) :
+  std::shared_future<void> {std::move(future)},
+  _cancelled               {std::move(cancelled)} {
+}
+
+// Function: cancel
+inline bool Future::cancel() {
+  if(_cancelled == nullptr ||
+     wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+    return false;
+  }
+  _cancelled->store(true, std::memory_order_relaxed);
+  return true;
+}
+
+// Function: is_cancelled
+inline bool Future::is_cancelled() const {
+  return _cancelled != nullptr && _cancelled->load(std::memory_order_relaxed);
+}
+
+}  // end of namespace tf. ---------------------------------------------------
+
@@ -4,8 +4,15 @@
 #include "../utility/traits.hpp"
 #include "../utility/singular_allocator.hpp"
 #include "../utility/passive_vector.hpp"
+#include "../utility/unique_function.hpp"
+#include "../threadpool/priority.hpp"
 #include <bitset>
 
+// Bytes of captured state a task callable can hold without a heap allocation
+#ifndef TF_TASK_INLINE_SIZE
+#define TF_TASK_INLINE_SIZE 48
+#endif
+
 namespace tf {
 
 // Forward declaration
@@ -16,8 +23,115 @@ class FlowBuilder;
 class SubflowBuilder;
 class Framework;
 
-//using Graph = std::list<Node>;
-using Graph = std::list<Node, tf::SingularAllocator<Node>>;
+// ----------------------------------------------------------------------------
+
+// Class: Graph
+// A chunked arena of nodes. Nodes are constructed in place in blocks of
+// geometrically growing capacity and never move, so pointers to them stay
+// valid until the graph is cleared. Iteration sweeps each block linearly, 
+// and the blocks are released wholesale after their nodes are destroyed.
+class Graph {
+
+  constexpr static size_t MIN_BLOCK_SIZE = 8;
+  constexpr static size_t MAX_BLOCK_SIZE = 1024;
+
+  struct Block {
+    Block* next {nullptr};
+    Node* nodes {nullptr};
+    size_t size {0};
+    size_t capacity {0};
+  };
+
+  template <typename N, typename B>
+  class Iterator {
+
+    friend class Graph;
+
+    public:
+
+      using iterator_category = std::forward_iterator_tag;
+      using value_type        = Node;
+      using difference_type   = std::ptrdiff_t;
+      using pointer           = N*;
+      using reference         = N&;
+
+      Iterator() = default;
+
+      reference operator * () const;
+      pointer operator -> () const;
+
+      Iterator& operator ++ ();
+      Iterator operator ++ (int);
+
+      bool operator == (const Iterator& rhs) const;
+      bool operator != (const Iterator& rhs) const;
+
+    private:
+
+      Iterator(B* block, size_t index) : _block {block}, _index {index} {}
+
+      B* _block {nullptr};
+      size_t _index {0};
+  };
+
+  public:
+
+    using iterator       = Iterator<Node, Block>;
+    using const_iterator = Iterator<const Node, const Block>;
+
+    Graph() = default;
+    Graph(const Graph&) = delete;
+    Graph(Graph&&) noexcept;
+
+    ~Graph();
+
+    Graph& operator = (const Graph&) = delete;
+    Graph& operator = (Graph&&) noexcept;
+
+    bool empty() const;
+    size_t size() const;
+
+    iterator begin();
+    iterator end();
+    const_iterator begin() const;
+    const_iterator end() const;
+    
+    Node& back();
+    const Node& back() const;
+
+    template <typename... ArgsT>
+    Node& emplace_back(ArgsT&&...);
+
+    void splice(Graph&);
+    void clear();
+
+  private:
+
+    Block* _head {nullptr};
+    Block* _tail {nullptr};
+    size_t _size {0};
+
+    Block* _allocate_block(size_t);
+};
+
+// ----------------------------------------------------------------------------
+
+// Class: Waker
+// Reschedules a stream task parked on a channel through the executor that 
+// ran it, without the channel knowing the type of the executor. It also 
+// tells the stream task whether its run has been cancelled.
+struct Waker {
+
+  void* executor {nullptr};
+  void (*schedule)(void*, Node&) {nullptr};
+  const std::atomic<bool>* cancelled {nullptr};
+
+  void operator () (Node& node) const { schedule(executor, node); }
+
+  bool is_cancelled() const { 
+    return cancelled && cancelled->load(std::memory_order_relaxed); 
+  }
+};
 
 // ----------------------------------------------------------------------------
 
@@ -25,18 +139,32 @@ using Graph = std::list<Node, tf::SingularAllocator<Node>>;
 class Node {
 
   friend class Task;
+  friend class FlowBuilder;
   friend class Topology;
+  friend class Plan;
+  friend class Pipeline;
 
   template <template<typename...> typename E> 
   friend class BasicTaskflow;
 
-  using StaticWork   = std::function<void()>;
-  using DynamicWork  = std::function<void(SubflowBuilder&)>;
+  using StaticWork   = UniqueFunction<void(), TF_TASK_INLINE_SIZE>;
+  using DynamicWork  = UniqueFunction<void(SubflowBuilder&), TF_TASK_INLINE_SIZE>;
+
+  // A stream work returns false when it parks on a channel and true when it
+  // is done; a parked task is rescheduled by the other end of the channel.
+  using StreamWork   = UniqueFunction<bool(Node&, const Waker&), TF_TASK_INLINE_SIZE>;
+
+  // A condition work returns the index of the one successor to run next;
+  // its edges are not counted by the join counters of the successors.
+  using ConditionWork = UniqueFunction<int(), TF_TASK_INLINE_SIZE>;
 
   constexpr static int SPAWNED = 0x1;
   constexpr static int SUBTASK = 0x2;
   constexpr static int PIPELINE = 0x4;
   constexpr static int WORKGROUP = 0x8;
+  constexpr static int DATAFLOW = 0x10;
+
+  constexpr static size_t cacheline_size = 64;
 
   public:
 
@@ -53,6 +181,9 @@ class Node {
 
     size_t num_successors() const;
     size_t num_dependents() const;
+    size_t num_strong_dependents() const;
+
+    bool is_condition() const;
 
     std::string dump() const;
 
@@ -61,38 +192,57 @@ class Node {
     bool is_subtask() const { return _status & SUBTASK; }
     bool is_pipeline() const { return _status & PIPELINE; }
     bool is_workgroup() const { return _status & WORKGROUP; }
+    bool is_dataflow() const { return _status & DATAFLOW; }
 
     void set_spawned()   { _status |= SPAWNED; }
     void set_subtask()   { _status |= SUBTASK; }
     void set_pipeline()  { _status |= PIPELINE; }
     void set_workgroup()  { _status |= WORKGROUP; }
+    void set_dataflow()  { _status |= DATAFLOW; }
 
     void unset_spawned()   { _status &= ~SPAWNED; }
     void unset_subtask()   { _status &= ~SUBTASK; }
     void unset_pipeline()  { _status &= ~PIPELINE; }
     void unset_workgroup()  { _status &= ~WORKGROUP; }
 
-    void clear_status() { _status = 0; }
+    // A dataflow task keeps its mark across runs.
+    void clear_status() { _status &= DATAFLOW; }
 
   private:
-    
-    std::string _name;
-    std::variant<StaticWork, DynamicWork> _work;
 
-    tf::PassiveVector<Node*> _successors;
-    tf::PassiveVector<Node*> _dependents;
+    // Hot block: the fields the scheduler touches for each executed task and
+    // for each successor it releases, packed into a single cache line. The
+    // status and the priority are kept in a byte each, and one successor is
+    // kept inline, to make room for the topology and the window slot.
+    alignas(cacheline_size) std::atomic<int> _num_dependents;
 
-    std::atomic<int> _num_dependents;
+    uint8_t _status {0};
 
-    std::optional<Graph> _subgraph;
+    uint8_t _priority {static_cast<uint8_t>(TaskPriority::NORMAL)};
+
+    // Position of the node in the execution plan of its framework or line
+    // of its pipeline.
+    unsigned _index {0};
+
+    // Window slot of the iteration of an overlapped framework run the task
+    // executes next.
+    unsigned _slot {0};
 
     Topology* _topology;
 
-    int _status {0};
+    tf::PassiveVector<Node*, 1> _successors;
+
+    // Work of the task, read once when the task itself runs. It starts the
+    // second cache line and stays inline, since a pointer to it would cost
+    // an allocation per task and a dependent load on each run.
+    std::variant<StaticWork, DynamicWork, StreamWork, ConditionWork> _work;
+    
+    // Cold block: fields used only to build, dump, or spawn.
+    std::string _name;
+
+    tf::PassiveVector<Node*> _dependents;
 
-    // Pipeline 
-    std::atomic<unsigned> _num_run {0};
-    unsigned _cur_pipeline {0};
+    std::optional<Graph> _subgraph;
 };
 
 // Constructor
@@ -129,6 +279,196 @@ inline Node::~Node() {
   }
 }
 
+// ----------------------------------------------------------------------------
+// Graph Iterator Method Definitions
+// ----------------------------------------------------------------------------
+
+// Operator: *
+template <typename N, typename B>
+inline N& Graph::Iterator<N, B>::operator * () const {
+  return _block->nodes[_index];
+}
+
+// Operator: ->
+template <typename N, typename B>
+inline N* Graph::Iterator<N, B>::operator -> () const {
+  return _block->nodes + _index;
+}
+
+// Operator: ++ (prefix)
+template <typename N, typename B>
+inline Graph::Iterator<N, B>& Graph::Iterator<N, B>::operator ++ () {
+  if(++_index == _block->size) {
+    _block = _block->next;
+    _index = 0;
+  }
+  return *this;
+}
+
+// Operator: ++ (postfix)
+template <typename N, typename B>
+inline Graph::Iterator<N, B> Graph::Iterator<N, B>::operator ++ (int) {
+  auto tmp = *this;
+  ++(*this);
+  return tmp;
+}
+
+// Operator: ==
+template <typename N, typename B>
+inline bool Graph::Iterator<N, B>::operator == (const Iterator& rhs) const {
+  return _block == rhs._block && _index == rhs._index;
+}
+
+// Operator: !=
+template <typename N, typename B>
+inline bool Graph::Iterator<N, B>::operator != (const Iterator& rhs) const {
+  return !(*this == rhs);
+}
+
+// ----------------------------------------------------------------------------
+// Graph Method Definitions
+// ----------------------------------------------------------------------------
+
+// Move constructor
+inline Graph::Graph(Graph&& rhs) noexcept :
+  _head {rhs._head},
+  _tail {rhs._tail},
+  _size {rhs._size} {
+  rhs._head = rhs._tail = nullptr;
+  rhs._size = 0;
+}
+
+// Destructor
+inline Graph::~Graph() {
+  clear();
+}
+
+// Move assignment
+inline Graph& Graph::operator = (Graph&& rhs) noexcept {
+  if(this != &rhs) {
+    clear();
+    _head = rhs._head;
+    _tail = rhs._tail;
+    _size = rhs._size;
+    rhs._head = rhs._tail = nullptr;
+    rhs._size = 0;
+  }
+  return *this;
+}
+
+// Function: empty
+inline bool Graph::empty() const {
+  return _size == 0;
+}
+
+// Function: size
+inline size_t Graph::size() const {
+  return _size;
+}
+
+// Function: begin
+inline Graph::iterator Graph::begin() {
+  return iterator(_head, 0);
+}
+
+// Function: end
+inline Graph::iterator Graph::end() {
+  return iterator();
+}
+
+// Function: begin
+inline Graph::const_iterator Graph::begin() const {
+  return const_iterator(_head, 0);
+}
+
+// Function: end
+inline Graph::const_iterator Graph::end() const {
+  return const_iterator();
+}
+
+// Function: back
+inline Node& Graph::back() {
+  return _tail->nodes[_tail->size - 1];
+}
+
+// Function: back
+inline const Node& Graph::back() const {
+  return _tail->nodes[_tail->size - 1];
+}
+
+// Function: _allocate_block
+// Allocates the block header and its node storage in one piece.
+inline Graph::Block* Graph::_allocate_block(size_t capacity) {
+  constexpr size_t header = (sizeof(Block) + alignof(Node) - 1) / alignof(Node) * alignof(Node);
+  auto ptr = static_cast<std::byte*>(
+    ::operator new(header + capacity * sizeof(Node), std::align_val_t{alignof(Node)})
+  );
+  auto block = ::new (ptr) Block;
+  block->nodes = reinterpret_cast<Node*>(ptr + header);
+  block->capacity = capacity;
+  return block;
+}
+
+// Function: emplace_back
+template <typename... ArgsT>
+Node& Graph::emplace_back(ArgsT&&... args) {
+
+  if(_tail == nullptr || _tail->size == _tail->capacity) {
+    auto block = _allocate_block(
+      _tail ? std::min(_tail->capacity * 2, MAX_BLOCK_SIZE) : MIN_BLOCK_SIZE
+    );
+    (_tail ? _tail->next : _head) = block;
+    _tail = block;
+  }
+
+  auto node = ::new (_tail->nodes + _tail->size) Node(std::forward<ArgsT>(args)...);
+  ++_tail->size;
+  ++_size;
+
+  return *node;
+}
+
+// Procedure: splice
+// Moves all nodes of the other graph to the end of this graph. The nodes
+// stay in their blocks, so pointers to them remain valid.
+inline void Graph::splice(Graph& rhs) {
+
+  if(rhs._head == nullptr) {
+    return;
+  }
+
+  if(_tail == nullptr) {
+    *this = std::move(rhs);
+    return;
+  }
+
+  _tail->next = rhs._head;
+  _tail = rhs._tail;
+  _size += rhs._size;
+
+  rhs._head = rhs._tail = nullptr;
+  rhs._size = 0;
+}
+
+// Procedure: clear
+inline void Graph::clear() {
+  while(_head) {
+    auto block = _head;
+    _head = block->next;
+    for(size_t i=0; i<block->size; ++i) {
+      block->nodes[i].~Node();
+    }
+    block->~Block();
+    ::operator delete(block, std::align_val_t{alignof(Node)});
+  }
+  _tail = nullptr;
+  _size = 0;
+}
+
+// ----------------------------------------------------------------------------
+// Node Method Definitions
+// ----------------------------------------------------------------------------
+
 // Procedure: precede
 inline void Node::precede(Node& v) {
   _successors.push_back(&v);
@@ -146,6 +486,24 @@ inline size_t Node::num_dependents() const {
   return _dependents.size();
 }
 
+// Function: num_strong_dependents
+// Counts the dependents that are not condition tasks, i.e., the dependents
+// that decrement the join counter of the node.
+inline size_t Node::num_strong_dependents() const {
+  size_t n = 0;
+  for(auto d : _dependents) {
+    if(!d->is_condition()) {
+      ++n;
+    }
+  }
+  return n;
+}
+
+// Function: is_condition
+inline bool Node::is_condition() const {
+  return _work.index() == 3;
+}
+
 // Function: name
 inline const std::string& Node::name() const {
   return _name;
@@ -163,9 +521,12 @@ inline void Node::dump(std::ostream& os) const {
   
   if(_name.empty()) os << '\"' << this << '\"';
   else os << std::quoted(_name);
+  if(is_condition()) os << " [shape=diamond]";
   os << ";\n";
 
-  for(const auto s : _successors) {
+  for(size_t i=0; i<_successors.size(); ++i) {
+
+    const auto s = _successors[i];
 
     if(_name.empty()) os << '\"' << this << '\"';
     else os << std::quoted(_name);
@@ -175,6 +536,8 @@ inline void Node::dump(std::ostream& os) const {
     if(s->name().empty()) os << '\"' << s << '\"';
     else os << std::quoted(s->name());
 
+    if(is_condition()) os << " [style=dashed label=\"" << i << "\"]";
+
     os << ";\n";
   }
   
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cstddef>
+
+namespace tf {
+
+/**
+@enum PartitionerType
+
+@brief the policy by which a parallel_for divides its range among tasks
+*/
+enum class PartitionerType : int {
+  /** @brief cuts the range into equal chunks when the graph is built */
+  STATIC = 0,
+  /** @brief tasks take fixed-size chunks from a shared cursor at run time */
+  DYNAMIC,
+  /** @brief tasks take chunks from a shared cursor that shrink as the range is consumed */
+  GUIDED,
+  /** @brief each task owns a block of the range and takes chunks from other blocks when done */
+  AUTO
+};
+
+/**
+@class Partitioner
+
+@brief The partitioning policy and chunk size of a parallel_for.
+
+A partitioner is passed by value to tf::FlowBuilder::parallel_for through
+one of tf::StaticPartitioner, tf::DynamicPartitioner, tf::GuidedPartitioner,
+and tf::AutoPartitioner. A chunk size of zero picks a default for the policy.
+*/
+class Partitioner {
+
+  public:
+
+    /**
+    @brief queries the partitioning policy
+    */
+    PartitionerType type() const { return _type; }
+
+    /**
+    @brief queries the chunk size, or zero for the default of the policy
+    */
+    size_t chunk() const { return _chunk; }
+
+  protected:
+
+    Partitioner(PartitionerType type, size_t chunk) : _type {type}, _chunk {chunk} {}
+
+  private:
+
+    PartitionerType _type;
+    size_t _chunk;
+};
+
+/**
+@class StaticPartitioner
+
+@brief Creates one task per chunk when the graph is built.
+
+The default chunk size divides the range evenly among the workers.
+This has the least run-time overhead and suits elements of uniform cost.
+*/
+class StaticPartitioner : public Partitioner {
+  public:
+    explicit StaticPartitioner(size_t chunk = 0) :
+      Partitioner(PartitionerType::STATIC, chunk) {}
+};
+
+/**
+@class DynamicPartitioner
+
+@brief Creates one task per worker; the tasks repeatedly take the
+       next chunk of the range from a shared atomic cursor.
+
+The default chunk size is one element. This balances elements of skewed
+cost at the price of one atomic operation per chunk.
+*/
+class DynamicPartitioner : public Partitioner {
+  public:
+    explicit DynamicPartitioner(size_t chunk = 0) :
+      Partitioner(PartitionerType::DYNAMIC, chunk) {}
+};
+
+/**
+@class GuidedPartitioner
+
+@brief Like tf::DynamicPartitioner, but each chunk taken is proportional to
+       the remaining elements divided by twice the number of tasks, and no
+       smaller than the chunk size.
+
+Large chunks at the start keep the number of atomic operations low, and
+small chunks at the end balance the tail of the loop.
+*/
+class GuidedPartitioner : public Partitioner {
+  public:
+    explicit GuidedPartitioner(size_t chunk = 0) :
+      Partitioner(PartitionerType::GUIDED, chunk) {}
+};
+
+/**
+@class AutoPartitioner
+
+@brief Creates one task per worker, each owning a contiguous block
+       of the range. A task works through its own block chunk by chunk
+       and then takes chunks from the blocks of the other tasks.
+
+A loop with uniform cost runs as a static partition with contiguous
+blocks, and a skewed loop is balanced by taking chunks from the busy blocks.
+The default chunk size is an eighth of a block.
+*/
+class AutoPartitioner : public Partitioner {
+  public:
+    explicit AutoPartitioner(size_t chunk = 0) :
+      Partitioner(PartitionerType::AUTO, chunk) {}
+};
+
+}  // end of namespace tf. ---------------------------------------------------
+
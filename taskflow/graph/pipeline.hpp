@@ -0,0 +1,288 @@
+#pragma once
+
+#include "graph.hpp"
+
+namespace tf {
+
+/**
+@enum PipeType
+
+@brief the type of a pipe (stage) in a pipeline
+*/
+enum class PipeType : int {
+  /** @brief processes tokens in parallel */
+  PARALLEL = 1,
+  /** @brief processes one token at a time in the order of tokens */
+  SERIAL   = 2
+};
+
+/**
+@class Pipeflow
+
+@brief The runtime view of a pipe processing a token.
+
+A pipeflow is passed to each invocation of a pipe callable to tell which
+token it processes and on which line. Data passed between pipes are kept
+in per-pipe buffers indexed by the line, since a line carries one token
+through all pipes at a time.
+*/
+class Pipeflow {
+
+  template <template<typename...> typename E>
+  friend class BasicTaskflow;
+
+  friend class Pipeline;
+
+  public:
+
+    /**
+    @brief queries the line of the token
+    */
+    size_t line() const { return _line; }
+
+    /**
+    @brief queries the pipe being run
+    */
+    size_t pipe() const { return _pipe; }
+
+    /**
+    @brief queries the token, i.e., the number of tokens before this one
+    */
+    size_t token() const { return _token; }
+
+    /**
+    @brief stops the pipeline from generating more tokens
+
+    Only the first pipe can stop the pipeline; the call has no effect in 
+    other pipes. The token on which it is called is discarded and tokens
+    in flight run to completion.
+    */
+    void stop() { _stop = true; }
+
+  private:
+
+    size_t _line;
+    size_t _pipe;
+    size_t _token;
+    bool _stop;
+};
+
+/**
+@class Pipe
+
+@brief A stage of a pipeline: a callable taking a tf::Pipeflow and a type.
+*/
+class Pipe {
+
+  template <template<typename...> typename E>
+  friend class BasicTaskflow;
+
+  friend class Pipeline;
+
+  public:
+
+    /**
+    @brief constructs a pipe
+
+    @param type the type of the pipe, serial or parallel
+    @param callable a callable object invocable with a tf::Pipeflow&
+    */
+    template <typename C>
+    Pipe(PipeType type, C&& callable);
+
+    /**
+    @brief queries the type of the pipe
+    */
+    PipeType type() const { return _type; }
+
+  private:
+
+    PipeType _type;
+
+    UniqueFunction<void(Pipeflow&), TF_TASK_INLINE_SIZE> _callable;
+};
+
+// Constructor
+template <typename C>
+Pipe::Pipe(PipeType type, C&& callable) :
+  _type     {type},
+  _callable {std::forward<C>(callable)} {
+}
+
+/**
+@class Pipeline
+
+@brief A linear pipeline of pipes run over a fixed number of lines.
+
+The first pipe generates tokens until it calls tf::Pipeflow::stop. Each
+token flows through the pipes in order on one of the lines, so at most
+as many tokens as lines are in flight. A serial pipe processes tokens one
+at a time in token order, while a parallel pipe may process the tokens of
+different lines at once. The first pipe must be serial.
+
+A pipeline is run by tf::BasicTaskflow::run. Its lines are scheduled as
+tasks of the executor, which run as many pipes as are ready and return
+instead of blocking for the rest.
+
+@code{.cpp}
+std::array<int, 4> buffer;
+tf::Pipeline pl(4,
+  tf::Pipe{tf::PipeType::SERIAL, [&](tf::Pipeflow& pf) {
+    if(pf.token() == 100) pf.stop();
+    else buffer[pf.line()] = pf.token();
+  }},
+  tf::Pipe{tf::PipeType::PARALLEL, [&](tf::Pipeflow& pf) {
+    buffer[pf.line()] *= 2;
+  }},
+  tf::Pipe{tf::PipeType::SERIAL, [&](tf::Pipeflow& pf) {
+    std::cout << buffer[pf.line()] << '\n';
+  }}
+);
+taskflow.run(pl).get();
+@endcode
+*/
+class Pipeline {
+
+  template <template<typename...> typename E>
+  friend class BasicTaskflow;
+
+  friend class Topology;
+
+  public:
+
+    /**
+    @brief constructs a pipeline
+
+    @param num_lines the number of tokens in flight
+    @param pipes the pipes in order
+    */
+    template <typename... Ps>
+    Pipeline(size_t num_lines, Ps&&... pipes);
+
+    /**
+    @brief queries the number of lines
+    */
+    size_t num_lines() const;
+
+    /**
+    @brief queries the number of pipes
+    */
+    size_t num_pipes() const;
+
+    /**
+    @brief queries the number of tokens generated by the last or present run
+    */
+    size_t num_tokens() const;
+
+    /**
+    @brief dumps the lines of the pipeline to a std::ostream in DOT format
+    */
+    void dump(std::ostream& ostream) const;
+
+  private:
+
+    Graph _graph;
+
+    std::vector<Node*> _lines;
+    std::vector<Pipe> _pipes;
+    std::vector<Pipeflow> _pipeflows;
+    std::unique_ptr<std::atomic<int>[]> _join_counters;
+
+    size_t _num_tokens {0};
+
+    std::mutex _mtx;
+    std::list<Topology*> _topologies;
+
+    std::atomic<int>& _join_counter(size_t, size_t);
+
+    void _reset();
+};
+
+// Constructor
+template <typename... Ps>
+Pipeline::Pipeline(size_t num_lines, Ps&&... pipes) {
+
+  (_pipes.emplace_back(std::forward<Ps>(pipes)), ...);
+
+  if(num_lines == 0) {
+    TF_THROW(Error::FLOW_BUILDER, "a pipeline needs at least one line");
+  }
+
+  if(_pipes.empty() || _pipes[0]._type != PipeType::SERIAL) {
+    TF_THROW(Error::FLOW_BUILDER, "the first pipe of a pipeline must be serial");
+  }
+
+  _pipeflows.resize(num_lines);
+  _lines.reserve(num_lines);
+  _join_counters = std::make_unique<std::atomic<int>[]>(num_lines * _pipes.size());
+
+  for(size_t l=0; l<num_lines; ++l) {
+    auto& node = _graph.emplace_back();
+    node._index = static_cast<unsigned>(l);
+    node.set_pipeline();
+    node._name = "line-" + std::to_string(l);
+    _lines.push_back(&node);
+  }
+}
+
+// Function: num_lines
+inline size_t Pipeline::num_lines() const {
+  return _pipeflows.size();
+}
+
+// Function: num_pipes
+inline size_t Pipeline::num_pipes() const {
+  return _pipes.size();
+}
+
+// Function: num_tokens
+inline size_t Pipeline::num_tokens() const {
+  return _num_tokens;
+}
+
+// Procedure: dump
+inline void Pipeline::dump(std::ostream& os) const {
+  os << "digraph Pipeline {\n";
+  for(const auto& n: _graph) {
+    n.dump(os);
+  }
+  os << "}\n";
+}
+
+// Function: _join_counter
+inline std::atomic<int>& Pipeline::_join_counter(size_t line, size_t pipe) {
+  return _join_counters[line * _pipes.size() + pipe];
+}
+
+// Procedure: _reset
+// Each pipe of a line waits for the previous pipe on the line; a serial
+// pipe also waits for the same pipe on the previous line, which holds the
+// previous token. The first pipe of a line waits for the last pipe on the
+// line to free it and, being serial, for the previous line to generate
+// the previous token. The first tokens have no previous line to wait for.
+inline void Pipeline::_reset() {
+
+  _num_tokens = 0;
+
+  for(size_t l=0; l<num_lines(); ++l) {
+    _pipeflows[l]._line = l;
+    _pipeflows[l]._pipe = 0;
+    _pipeflows[l]._token = 0;
+    _pipeflows[l]._stop = false;
+    for(size_t p=0; p<num_pipes(); ++p) {
+      int join = static_cast<int>(_pipes[p]._type);
+      if(l == 0 && p != 0) {
+        join = 1;
+      }
+      else if(l != 0 && p == 0) {
+        join = join - 1;
+      }
+      _join_counter(l, p).store(join, std::memory_order_relaxed);
+    }
+  }
+
+  _join_counter(0, 0).store(0, std::memory_order_relaxed);
+}
+
+}  // end of namespace tf. ---------------------------------------------------
+
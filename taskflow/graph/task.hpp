@@ -70,12 +70,33 @@ class Task {
     */
     Task& name(const std::string& name);
 
+    /**
+    @brief queries the priority of the task
+    */
+    TaskPriority priority() const;
+
+    /**
+    @brief assigns a priority to the task
+
+    Executors that support priorities run the ready tasks of a more urgent 
+    level before any task of a less urgent one. 
+    The default priority is TaskPriority::NORMAL.
+
+    @param level a TaskPriority value other than TaskPriority::MAX
+
+    @return @c *this
+    */
+    Task& priority(TaskPriority level);
+
     /**
     @brief assigns a new callable object to the task
 
+    The work of a task created by tf::FlowBuilder::dataflow passes values
+    between tasks and cannot be replaced.
+
     @tparam C callable object type
 
-    @param callable a callable object acceptable to @std_function
+    @param callable a callable object, which may be move-only
 
     @return @c *this
     */
@@ -268,7 +289,16 @@ inline Task::Task(Task&& rhs) : _node{rhs._node} {
 // Function: work
 template <typename C>
 inline Task& Task::work(C&& c) {
-  _node->_work = std::forward<C>(c);
+  if(_node->is_dataflow()) {
+    TF_THROW(Error::FLOW_BUILDER, "the work of a dataflow task cannot be replaced");
+  }
+  // a callable returning a value also converts to a condition work
+  if constexpr(std::is_invocable_v<C>) {
+    _node->_work.template emplace<Node::StaticWork>(std::forward<C>(c));
+  }
+  else {
+    _node->_work = std::forward<C>(c);
+  }
   return *this;
 }
 
@@ -283,6 +313,17 @@ inline const std::string& Task::name() const {
   return _node->_name;
 }
 
+// Function: priority
+inline Task& Task::priority(TaskPriority level) {
+  _node->_priority = static_cast<uint8_t>(level);
+  return *this;
+}
+
+// Function: priority
+inline TaskPriority Task::priority() const {
+  return static_cast<TaskPriority>(_node->_priority);
+}
+
 // Function: num_dependents
 inline size_t Task::num_dependents() const {
   return _node->num_dependents();
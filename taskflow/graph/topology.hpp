@@ -1,9 +1,107 @@
 #pragma once
 
 #include "framework.hpp"
+#include "pipeline.hpp"
+#include "future.hpp"
 
 namespace tf {
 
+// ----------------------------------------------------------------------------
+
+// Class: Window
+// The join counters of a framework run whose iterations overlap. Iteration k
+// uses the counters of slot k % size, so at most size iterations are in 
+// flight. Besides its predecessors, a task of iteration k waits for itself
+// in iteration k-1, and a source task also waits for iteration k-size to 
+// complete and release the slot. Iterations complete in order: the sinks of
+// iteration k also wait for iteration k-1 to complete.
+class Window {
+
+  template <template<typename...> typename E> 
+  friend class BasicTaskflow;
+
+  friend class Topology;
+
+  public:
+
+    Window(const Plan&, size_t);
+
+  private:
+
+    const size_t _size;
+    const size_t _num_nodes;
+
+    std::vector<int> _joins;
+    std::unique_ptr<std::atomic<int>[]> _counters;
+
+    const int _num_sinks;
+    std::unique_ptr<std::atomic<int>[]> _sinks;
+
+    // Touched only by the completion of iterations, which is serialized.
+    size_t _num_issued {0};
+    size_t _num_completed {0};
+    bool _stopped {false};
+
+    std::atomic<int>* _counters_of(size_t);
+    std::atomic<int>& _sinks_of(size_t);
+
+    unsigned _next(unsigned) const;
+
+    void _reset(const Plan&);
+};
+
+// Constructor
+inline Window::Window(const Plan& plan, size_t size) : 
+  _size      {size},
+  _num_nodes {plan._nodes.size()},
+  _joins     (plan._joins),
+  _counters  {std::make_unique<std::atomic<int>[]>(size * _num_nodes)},
+  _num_sinks {plan._num_sinks},
+  _sinks     {std::make_unique<std::atomic<int>[]>(size)} {
+  
+  for(auto& j : _joins) {
+    j += (j == 0) ? 2 : 1;
+  }
+}
+
+// Function: _counters_of
+inline std::atomic<int>* Window::_counters_of(size_t k) {
+  return &_counters[(k % _size) * _num_nodes];
+}
+
+// Function: _sinks_of
+inline std::atomic<int>& Window::_sinks_of(size_t k) {
+  return _sinks[k % _size];
+}
+
+// Function: _next
+// The slot of the iteration after the one in the given slot.
+inline unsigned Window::_next(unsigned slot) const {
+  return slot + 1 == _size ? 0 : slot + 1;
+}
+
+// Procedure: _reset
+// Sets up the counters once the first _num_issued iterations are admitted.
+// Iteration 0 waits for nothing but the predecessors of each task, and an
+// admitted iteration does not wait for its slot. The sources of iteration 0
+// are scheduled at once, so their counters start over for iteration size.
+inline void Window::_reset(const Plan& plan) {
+  for(size_t k=0; k<_size; ++k) {
+    auto counters = _counters_of(k);
+    for(size_t i=0; i<_num_nodes; ++i) {
+      int join = _joins[i];
+      if(k > 0 && k < _num_issued && plan._joins[i] == 0) {
+        --join;
+      }
+      else if(k == 0 && plan._joins[i] != 0) {
+        --join;
+      }
+      counters[i].store(join, std::memory_order_relaxed);
+    }
+    _sinks[k].store(_num_sinks + (k == 0 ? 0 : 1), std::memory_order_relaxed);
+  }
+}
+
 // ----------------------------------------------------------------------------
   
 // class: Topology
@@ -38,16 +136,26 @@ class Topology {
     template <typename P>
     Topology(WorkGroup&, P&&);
 
+    Topology(Pipeline&);
+
     std::string dump() const;
     void dump(std::ostream&) const;
 
   private:
 
-    std::variant<Graph, Framework*, WorkGroup*> _handle;
+    std::variant<Graph, Framework*, WorkGroup*, Pipeline*> _handle;
 
     std::promise<void> _promise;
     std::shared_future<void> _future {_promise.get_future().share()};
 
+    // Shared with the futures of the run, which may outlive the topology.
+    std::shared_ptr<std::atomic<bool>> _cancelled {
+      std::make_shared<std::atomic<bool>>(false)
+    };
+
+    std::atomic<bool> _has_exception {false};
+    std::exception_ptr _exception;
+
     PassiveVector<Node*> _sources;
     std::atomic<int> _num_sinks {0};
     int _cached_num_sinks {0};
@@ -55,11 +163,23 @@ class Topology {
     std::function<bool()> _predicate {nullptr};
     std::function<void()> _work {nullptr};
 
+    Plan* _plan {nullptr};
+
+    std::unique_ptr<Window> _window;
+
+    // The graph has condition tasks, so not every sink may run; the sink 
+    // number then counts the tasks in flight instead.
+    bool _branched {false};
+
     void _bind(Graph& g);
+    void _bind(Framework& f, size_t overlap);
+    void _bind(Pipeline& p);
     void _recover_num_sinks();
 
-    // Pipeline
-    std::atomic<unsigned> _num_pipeline {1};
+    bool _is_cancelled() const;
+
+    void _capture(std::exception_ptr);
+    void _complete();
 };
 
 
@@ -78,6 +198,11 @@ inline Topology::Topology(Framework& f, P&& p):
   _predicate {std::forward<P>(p)} {
 }
 
+// Constructor
+inline Topology::Topology(Pipeline& p): 
+  _handle {&p} {
+}
+
 // Constructor
 inline Topology::Topology(Graph&& t) : 
   _handle {std::move(t)} {
@@ -95,11 +220,15 @@ inline Topology::Topology(Graph&& t, C&& c) :
 }
 
 // Procedure: _bind
-// Re-builds the source links and the sink number for this topology.
+// Re-builds the source links and the sink number for this topology. In a
+// graph with condition tasks, the join counters count only the edges that
+// are not from condition tasks, and the run starts with its sources in 
+// flight.
 inline void Topology::_bind(Graph& g) {
   
   _num_sinks = 0;
   _sources.clear();
+  _branched = false;
   
   // scan each node in the graph and build up the links
   for(auto& node : g) {
@@ -113,14 +242,119 @@ inline void Topology::_bind(Graph& g) {
     if(node.num_successors() == 0) {
       _num_sinks++;
     }
+
+    if(node.is_condition()) {
+      _branched = true;
+    }
+  }
+
+  if(_branched) {
+    for(auto& node : g) {
+      node._num_dependents = node.num_strong_dependents();
+    }
+    _num_sinks = static_cast<int>(_sources.size());
   }
+
   _cached_num_sinks = _num_sinks;
 
 }
 
+// Procedure: _bind
+// Binds this topology to the execution plan of a framework, compiling the
+// plan first if the framework is not frozen or has changed since. With an
+// overlap above one, the first iterations up to the overlap are admitted 
+// at once, which evaluates the predicate for each. A plan with condition
+// or dataflow tasks does not overlap its iterations.
+inline void Topology::_bind(Framework& f, size_t overlap) {
+
+  _plan = &f._frozen_plan();
+  
+  _sources.clear();
+
+  for(auto node : _plan->_nodes) {
+    node->_topology = this;
+    node->_slot = 0;
+  }
+
+  for(auto node : _plan->_sources) {
+    _sources.push_back(node);
+  }
+
+  _plan->_reset();
+
+  _branched = _plan->_branched;
+  _num_sinks = _branched ? static_cast<int>(_sources.size()) : _plan->_num_sinks;
+  _cached_num_sinks = _num_sinks;
+
+  if(overlap > 1 && !_plan->_nodes.empty() && !_plan->_serial) {
+    _window = std::make_unique<Window>(*_plan, overlap);
+    _window->_num_issued = 1;
+    while(_window->_num_issued < overlap) {
+      if(std::invoke(_predicate)) {
+        _window->_stopped = true;
+        break;
+      }
+      ++_window->_num_issued;
+    }
+    _window->_reset(*_plan);
+  }
+  else {
+    _window.reset();
+  }
+}
+
+// Procedure: _bind
+// Binds this topology to a pipeline. The run starts with the first line and
+// counts the lines being run by workers as its sinks.
+inline void Topology::_bind(Pipeline& p) {
+
+  p._reset();
+
+  for(auto node : p._lines) {
+    node->_topology = this;
+  }
+
+  _sources.clear();
+  _sources.push_back(p._lines[0]);
+  
+  _num_sinks = 1;
+  _cached_num_sinks = 1;
+}
+
 // Procedure: _recover_num_sinks
+// Also restores the join counters of a plan with condition tasks, since the
+// tasks of a branch not taken may have been released only in part.
 inline void Topology::_recover_num_sinks() {
   _num_sinks = _cached_num_sinks;
+  if(_branched && _plan) {
+    _plan->_reset();
+  }
+}
+
+// Function: _is_cancelled
+inline bool Topology::_is_cancelled() const {
+  return _cancelled->load(std::memory_order_relaxed);
+}
+
+// Procedure: _capture
+// Keeps the first exception thrown by a task of the run and cancels the 
+// rest of the run.
+inline void Topology::_capture(std::exception_ptr e) {
+  if(!_has_exception.exchange(true)) {
+    _exception = std::move(e);
+  }
+  _cancelled->store(true, std::memory_order_relaxed);
+}
+
+// Procedure: _complete
+// Sets the promise of the run, with the exception of a task if any.
+inline void Topology::_complete() {
+  if(_exception) {
+    _promise.set_exception(_exception);
+  }
+  else {
+    _promise.set_value();
+  }
 }
 
 // Procedure: dump
@@ -143,6 +377,11 @@ inline void Topology::dump(std::ostream& os) const {
       for(const auto& node : workgroup->_graph) {
         node.dump(os);
       }
+    },
+    [&] (const Pipeline* pipeline) {
+      for(const auto& node : pipeline->_graph) {
+        node.dump(os);
+      }
     }
   }, _handle);
 
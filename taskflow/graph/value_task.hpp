@@ -0,0 +1,127 @@
+#pragma once
+
+#include "task.hpp"
+
+namespace tf {
+
+/**
+@class ValueTask
+
+@brief A task that returns a value of type @c T to the tasks taking it as
+       an input.
+
+A value task is created by tf::FlowBuilder::dataflow from a callable that
+returns a value. Passing the value task as an input to another
+tf::FlowBuilder::dataflow call adds the edge between the two tasks and
+passes the value to the callable of the successor as an argument.
+
+The value is kept in storage owned by the task and is replaced each time the
+task runs. A value taken by one task is moved into it, and a value taken by
+several tasks is copied into each, so a move-only value can be taken by one
+task only. The storage is released once all tasks taking the value have run.
+Since a task keeps one value, a framework with value tasks runs its 
+iterations one at a time regardless of tf::Framework::overlap.
+
+A value task is a tf::Task and can be named and linked to other tasks as
+usual, but its work cannot be replaced by tf::Task::work.
+
+@code{.cpp}
+tf::ValueTask<int> A = taskflow.dataflow([] () { return 1; });
+tf::ValueTask<std::string> B = taskflow.dataflow([] () { return std::string("x"); });
+tf::ValueTask<std::string> C = taskflow.dataflow(
+  [] (int a, std::string b) { return b + std::to_string(a); }, A, B
+);
+taskflow.dataflow([] (std::string c) { std::cout << c << '\n'; }, C);
+@endcode
+*/
+template <typename T>
+class ValueTask : public Task {
+
+  friend class FlowBuilder;
+
+  // Class: Slot
+  // The storage of the value of one task. The number of consumers is fixed
+  // when the graph is built and the number of pending consumers counts them
+  // down in each run.
+  struct Slot {
+
+    std::optional<T> value;
+    size_t num_consumers {0};
+    std::atomic<size_t> num_pending {0};
+
+    template <typename... ArgsT>
+    void store(ArgsT&&...);
+
+    T&& take(std::optional<T>&);
+    void release();
+  };
+
+  public:
+
+    /**
+    @brief the type of the value
+    */
+    using value_type = T;
+
+    /**
+    @brief constructs an empty value task
+    */
+    ValueTask() = default;
+
+    /**
+    @brief queries the number of tasks taking the value as an input
+    */
+    size_t num_consumers() const;
+
+  private:
+
+    ValueTask(const Task&, std::shared_ptr<Slot>);
+
+    std::shared_ptr<Slot> _slot;
+};
+
+// Constructor
+template <typename T>
+ValueTask<T>::ValueTask(const Task& task, std::shared_ptr<Slot> slot) :
+  Task  {task},
+  _slot {std::move(slot)} {
+}
+
+// Function: num_consumers
+template <typename T>
+size_t ValueTask<T>::num_consumers() const {
+  return _slot ? _slot->num_consumers : 0;
+}
+
+// Procedure: store
+template <typename T>
+template <typename... ArgsT>
+void ValueTask<T>::Slot::store(ArgsT&&... args) {
+  num_pending.store(num_consumers, std::memory_order_relaxed);
+  value.emplace(std::forward<ArgsT>(args)...);
+}
+
+// Function: take
+// The only consumer takes the value itself; each of several consumers
+// takes a copy in storage of its own.
+template <typename T>
+T&& ValueTask<T>::Slot::take(std::optional<T>& copy) {
+  if constexpr(std::is_copy_constructible_v<T>) {
+    if(num_consumers > 1) {
+      return std::move(copy.emplace(*value));
+    }
+  }
+  return std::move(*value);
+}
+
+// Procedure: release
+// The last consumer of the run releases the value.
+template <typename T>
+void ValueTask<T>::Slot::release() {
+  if(num_pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    value.reset();
+  }
+}
+
+}  // end of namespace tf. ---------------------------------------------------
+
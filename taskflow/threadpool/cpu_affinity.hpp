@@ -0,0 +1,270 @@
+#pragma once
+
+#include "cpu_topology.hpp"
+
+namespace tf {
+
+/**
+@class: CpuAffinity
+
+@brief Policy to pin the worker threads of an executor to processors.
+
+A policy maps each worker to the set of processors it may run on:
+  + @c NONE:    workers are not pinned and the OS schedules them freely
+  + @c NUMA:    workers are spread evenly over the locality domains and
+                each worker may run on any processor of its domain
+  + @c COMPACT: worker @c i is pinned to the i-th processor, filling one
+                domain before moving to the next
+  + @c SCATTER: workers are pinned to processors in a round-robin manner
+                over the domains
+  + @c LIST:    worker @c i is pinned to the i-th processor set in a
+                user-given list (wrapped around if shorter)
+
+Isolated processors (Linux @c isolcpus) and user-given processors can be
+excluded from all policies.
+*/
+class CpuAffinity {
+
+  public:
+
+    /**
+    @enum Policy
+
+    @brief affinity policy type
+    */
+    enum Policy : int {
+      NONE = 0,
+      NUMA,
+      COMPACT,
+      SCATTER,
+      LIST
+    };
+
+    /**
+    @brief constructs a policy that does not pin any worker
+    */
+    CpuAffinity() = default;
+
+    /**
+    @brief constructs a policy of the given type over a topology
+    */
+    explicit CpuAffinity(Policy policy, const CpuTopology& topology = CpuTopology::system());
+
+    /**
+    @brief creates a policy that does not pin any worker
+    */
+    static CpuAffinity none();
+
+    /**
+    @brief creates a policy that pins each worker to a locality domain
+    */
+    static CpuAffinity numa(const CpuTopology& topology = CpuTopology::system());
+
+    /**
+    @brief creates a policy that pins workers to consecutive processors
+    */
+    static CpuAffinity compact(const CpuTopology& topology = CpuTopology::system());
+
+    /**
+    @brief creates a policy that pins workers round-robin over the domains
+    */
+    static CpuAffinity scatter(const CpuTopology& topology = CpuTopology::system());
+
+    /**
+    @brief creates a policy that pins worker @c i to the processor @c cpus[i]
+    */
+    static CpuAffinity list(const std::vector<unsigned>& cpus);
+
+    /**
+    @brief creates a policy that pins worker @c i to the processor set @c cpusets[i]
+    */
+    static CpuAffinity list(std::vector<std::vector<unsigned>> cpusets);
+
+    /**
+    @brief excludes the isolated processors of the system from the policy
+
+    The isolated processors are read from
+    <tt>/sys/devices/system/cpu/isolated</tt> on Linux.
+
+    @return @c *this
+    */
+    CpuAffinity& exclude_isolated();
+
+    /**
+    @brief excludes the given processors from the policy
+
+    @return @c *this
+    */
+    CpuAffinity& exclude(const std::vector<unsigned>& cpus);
+
+    /**
+    @brief queries the policy type
+    */
+    Policy policy() const;
+
+    /**
+    @brief queries the topology the policy is applied to
+           (excluded processors removed)
+    */
+    const CpuTopology& topology() const;
+
+    /**
+    @brief computes the processor set of each of the N workers
+
+    An empty set means the worker is not pinned.
+    */
+    std::vector<std::vector<unsigned>> cpusets(unsigned N) const;
+
+  private:
+
+    Policy _policy {NONE};
+
+    CpuTopology _topology;
+
+    std::vector<std::vector<unsigned>> _list;
+    std::vector<unsigned> _excluded;
+
+    bool _is_excluded(unsigned) const;
+};
+
+// Constructor
+inline CpuAffinity::CpuAffinity(Policy policy, const CpuTopology& topology) :
+  _policy   {policy},
+  _topology {topology} {
+}
+
+// Function: none
+inline CpuAffinity CpuAffinity::none() {
+  return CpuAffinity();
+}
+
+// Function: numa
+inline CpuAffinity CpuAffinity::numa(const CpuTopology& topology) {
+  return CpuAffinity(NUMA, topology);
+}
+
+// Function: compact
+inline CpuAffinity CpuAffinity::compact(const CpuTopology& topology) {
+  return CpuAffinity(COMPACT, topology);
+}
+
+// Function: scatter
+inline CpuAffinity CpuAffinity::scatter(const CpuTopology& topology) {
+  return CpuAffinity(SCATTER, topology);
+}
+
+// Function: list
+inline CpuAffinity CpuAffinity::list(const std::vector<unsigned>& cpus) {
+  std::vector<std::vector<unsigned>> cpusets;
+  for(auto c : cpus) {
+    cpusets.push_back({c});
+  }
+  return list(std::move(cpusets));
+}
+
+// Function: list
+inline CpuAffinity CpuAffinity::list(std::vector<std::vector<unsigned>> cpusets) {
+  CpuAffinity affinity(LIST);
+  affinity._list = std::move(cpusets);
+  return affinity;
+}
+
+// Function: exclude_isolated
+inline CpuAffinity& CpuAffinity::exclude_isolated() {
+
+#if defined(__linux__)
+  std::ifstream ifs("/sys/devices/system/cpu/isolated");
+  std::string cpulist;
+  if(ifs && std::getline(ifs, cpulist)) {
+    exclude(CpuTopology::parse_cpulist(cpulist));
+  }
+#endif
+
+  return *this;
+}
+
+// Function: exclude
+inline CpuAffinity& CpuAffinity::exclude(const std::vector<unsigned>& cpus) {
+
+  _excluded.insert(_excluded.end(), cpus.begin(), cpus.end());
+
+  std::vector<std::vector<unsigned>> domains;
+
+  for(size_t d=0; d<_topology.num_domains(); ++d) {
+    auto& domain = domains.emplace_back();
+    for(auto c : _topology.domain(d)) {
+      if(!_is_excluded(c)) {
+        domain.push_back(c);
+      }
+    }
+  }
+
+  // keep the topology untouched if nothing is left
+  if(std::any_of(domains.begin(), domains.end(), [] (auto& d) { return !d.empty(); })) {
+    _topology = CpuTopology(std::move(domains));
+  }
+
+  return *this;
+}
+
+// Function: policy
+inline CpuAffinity::Policy CpuAffinity::policy() const {
+  return _policy;
+}
+
+// Function: topology
+inline const CpuTopology& CpuAffinity::topology() const {
+  return _topology;
+}
+
+// Function: _is_excluded
+inline bool CpuAffinity::_is_excluded(unsigned cpu) const {
+  return std::find(_excluded.begin(), _excluded.end(), cpu) != _excluded.end();
+}
+
+// Function: cpusets
+inline std::vector<std::vector<unsigned>> CpuAffinity::cpusets(unsigned N) const {
+
+  std::vector<std::vector<unsigned>> sets(N);
+
+  const size_t D = _topology.num_domains();
+
+  for(unsigned i=0; i<N; ++i) {
+    switch(_policy) {
+      // a single domain spans all processors and needs no pinning
+      case NUMA:
+        if(D > 1) {
+          sets[i] = _topology.domain(i * std::min(D, size_t{N}) / N);
+        }
+      break;
+
+      case COMPACT:
+        sets[i] = {_topology.cpu_at(i)};
+      break;
+
+      case SCATTER: {
+        auto& d = _topology.domain(i % D);
+        sets[i] = {d[(i / D) % d.size()]};
+      }
+      break;
+
+      case LIST:
+        if(!_list.empty()) {
+          for(auto c : _list[i % _list.size()]) {
+            if(!_is_excluded(c)) {
+              sets[i].push_back(c);
+            }
+          }
+        }
+      break;
+
+      default:
+      break;
+    }
+  }
+
+  return sets;
+}
+
+}  // end of namespace tf. ---------------------------------------------------
+
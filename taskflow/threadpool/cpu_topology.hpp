@@ -0,0 +1,280 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <thread>
+#include <algorithm>
+#include <cstdlib>
+#include <cctype>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace tf {
+
+/**
+@class: CpuTopology
+
+@brief Groups the processors of the machine into locality domains.
+
+A locality domain is a set of processors that share the same memory
+controller (e.g., a NUMA node or a socket).
+On Linux, the domains are read from
+<tt>/sys/devices/system/node/node*</tt><tt>/cpulist</tt>
+and restricted to the processors the process may run on
+(e.g., under @c taskset).
+On other platforms, or when sysfs is unavailable, all processors
+reported by @std_thread::hardware_concurrency form a single domain.
+*/
+class CpuTopology {
+
+  public:
+
+    /**
+    @brief constructs a topology of a single domain with all processors
+    */
+    CpuTopology();
+
+    /**
+    @brief constructs a topology from a given list of domains
+
+    @param domains a list of processor id sets, one per domain
+    */
+    explicit CpuTopology(std::vector<std::vector<unsigned>> domains);
+
+    /**
+    @brief queries the topology of this machine (detected once)
+    */
+    static const CpuTopology& system();
+
+    /**
+    @brief parses a Linux cpulist string (e.g., "0-3,8,10-11")
+    */
+    static std::vector<unsigned> parse_cpulist(const std::string& cpulist);
+
+    /**
+    @brief queries the number of domains
+    */
+    size_t num_domains() const;
+
+    /**
+    @brief queries the number of processors over all domains
+    */
+    size_t num_cpus() const;
+
+    /**
+    @brief queries the processors in the given domain
+    */
+    const std::vector<unsigned>& domain(size_t d) const;
+
+    /**
+    @brief queries the domain of the given processor
+
+    Processors not in any domain are reported in domain 0.
+    */
+    size_t domain_of(unsigned cpu) const;
+
+    /**
+    @brief queries the processor at the given position when all processors
+           are enumerated domain by domain
+    */
+    unsigned cpu_at(size_t i) const;
+
+  private:
+
+    std::vector<std::vector<unsigned>> _domains;
+    std::vector<unsigned> _cpus;
+
+    static CpuTopology _detect();
+    static std::vector<unsigned> _allowed_cpus();
+};
+
+// Constructor
+inline CpuTopology::CpuTopology() {
+
+  std::vector<unsigned> cpus(std::max(1u, std::thread::hardware_concurrency()));
+
+  for(unsigned i=0; i<cpus.size(); ++i) {
+    cpus[i] = i;
+  }
+
+  _domains.push_back(std::move(cpus));
+  _cpus = _domains[0];
+}
+
+// Constructor
+inline CpuTopology::CpuTopology(std::vector<std::vector<unsigned>> domains) :
+  _domains {std::move(domains)} {
+
+  _domains.erase(
+    std::remove_if(_domains.begin(), _domains.end(), [] (const auto& d) {
+      return d.empty();
+    }),
+    _domains.end()
+  );
+
+  if(_domains.empty()) {
+    *this = CpuTopology();
+    return;
+  }
+
+  for(const auto& d : _domains) {
+    _cpus.insert(_cpus.end(), d.begin(), d.end());
+  }
+}
+
+// Function: system
+inline const CpuTopology& CpuTopology::system() {
+  static const CpuTopology topology = _detect();
+  return topology;
+}
+
+// Function: _detect
+inline CpuTopology CpuTopology::_detect() {
+
+  std::vector<std::vector<unsigned>> domains;
+
+#if defined(__linux__)
+  // node ids may be sparse, so we tolerate a few missing entries
+  for(unsigned n=0, misses=0; misses < 8; ++n) {
+    std::ifstream ifs(
+      "/sys/devices/system/node/node" + std::to_string(n) + "/cpulist"
+    );
+    if(!ifs) {
+      ++misses;
+      continue;
+    }
+    misses = 0;
+    std::string cpulist;
+    std::getline(ifs, cpulist);
+    domains.push_back(parse_cpulist(cpulist));
+  }
+#endif
+
+  // keep only the processors in the affinity mask of the process, which
+  // forms a single domain if no node has any of them
+  if(auto allowed = _allowed_cpus(); !allowed.empty()) {
+    for(auto& d : domains) {
+      d.erase(
+        std::remove_if(d.begin(), d.end(), [&] (unsigned c) {
+          return !std::binary_search(allowed.begin(), allowed.end(), c);
+        }),
+        d.end()
+      );
+    }
+    if(std::all_of(domains.begin(), domains.end(), [] (auto& d) { return d.empty(); })) {
+      domains.assign(1, std::move(allowed));
+    }
+  }
+
+  return CpuTopology(std::move(domains));
+}
+
+// Function: _allowed_cpus
+// Returns the sorted processors the process may run on, or an empty set 
+// if the affinity mask is not available.
+inline std::vector<unsigned> CpuTopology::_allowed_cpus() {
+
+  std::vector<unsigned> cpus;
+
+#if defined(__linux__)
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if(sched_getaffinity(0, sizeof(set), &set) == 0) {
+    for(unsigned c=0; c<CPU_SETSIZE; ++c) {
+      if(CPU_ISSET(c, &set)) {
+        cpus.push_back(c);
+      }
+    }
+  }
+#endif
+
+  return cpus;
+}
+
+// Function: parse_cpulist
+inline std::vector<unsigned> CpuTopology::parse_cpulist(const std::string& str) {
+
+  std::vector<unsigned> cpus;
+  std::istringstream iss(str);
+  std::string token;
+
+  while(std::getline(iss, token, ',')) {
+
+    if(token.empty() || !std::isdigit(static_cast<unsigned char>(token[0]))) {
+      continue;
+    }
+
+    char* p {nullptr};
+    auto beg = std::strtoul(token.c_str(), &p, 10);
+    auto end = (*p == '-') ? std::strtoul(p + 1, nullptr, 10) : beg;
+
+    for(auto c = beg; c <= end; ++c) {
+      cpus.push_back(static_cast<unsigned>(c));
+    }
+  }
+
+  return cpus;
+}
+
+// Function: num_domains
+inline size_t CpuTopology::num_domains() const {
+  return _domains.size();
+}
+
+// Function: num_cpus
+inline size_t CpuTopology::num_cpus() const {
+  return _cpus.size();
+}
+
+// Function: domain
+inline const std::vector<unsigned>& CpuTopology::domain(size_t d) const {
+  return _domains[d];
+}
+
+// Function: domain_of
+inline size_t CpuTopology::domain_of(unsigned cpu) const {
+  for(size_t d=0; d<_domains.size(); ++d) {
+    if(std::find(_domains[d].begin(), _domains[d].end(), cpu) != _domains[d].end()) {
+      return d;
+    }
+  }
+  return 0;
+}
+
+// Function: cpu_at
+inline unsigned CpuTopology::cpu_at(size_t i) const {
+  return _cpus[i % _cpus.size()];
+}
+
+// ----------------------------------------------------------------------------
+
+// Procedure: bind_this_thread
+// Restricts the calling thread to the given processors.
+// This is a no-op on platforms without thread affinity support.
+inline bool bind_this_thread(const std::vector<unsigned>& cpus) {
+
+  if(cpus.empty()) {
+    return false;
+  }
+
+#if defined(__linux__)
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for(auto c : cpus) {
+    if(c < CPU_SETSIZE) {
+      CPU_SET(c, &set);
+    }
+  }
+  return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+  return false;
+#endif
+}
+
+}  // end of namespace tf. ---------------------------------------------------
+
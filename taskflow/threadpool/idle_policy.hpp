@@ -0,0 +1,242 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+namespace tf {
+
+// Procedure: relax_cpu
+// Hints the processor that the caller is in a spin-wait loop.
+inline void relax_cpu() {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+  _mm_pause();
+#elif defined(__i386__) || defined(__x86_64__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+  __asm__ __volatile__("yield");
+#endif
+}
+
+/**
+@class: IdlePolicy
+
+@brief Policy that decides how a worker without work waits for new work.
+
+An idle worker goes through three phases before it sleeps:
+  + @c spin:  up to a spin budget of stealing rounds, with an exponential
+              backoff of @c pause instructions between failed rounds
+  + @c yield: a number of stealing rounds, each after yielding the processor
+  + @c sleep: the worker blocks until new work is submitted
+
+Only a limited number of workers spin or yield at the same time; the others
+sleep right away. With adaptation on, each worker doubles its spin budget
+(up to the maximum) after the idle phases found work, and halves it (down
+to the minimum) after they failed, so the budget follows the recent steal
+success rate.
+*/
+class IdlePolicy {
+
+  public:
+
+    /**
+    @brief constructs the default policy (spin budget 64 to 1024 rounds,
+           pause backoff up to 16, 8 yield rounds, one spinner, adaptive)
+    */
+    IdlePolicy() = default;
+
+    /**
+    @brief creates a policy for latency-critical deployments that spins
+           long before sleeping
+    */
+    static IdlePolicy latency();
+
+    /**
+    @brief creates a policy for batch hosts that sleeps almost immediately
+    */
+    static IdlePolicy power_saving();
+
+    /**
+    @brief sets the minimum and maximum number of stealing rounds in the spin phase
+
+    @return @c *this
+    */
+    IdlePolicy& spin_budget(unsigned min, unsigned max);
+
+    /**
+    @brief sets the maximum number of @c pause instructions between
+           two failed stealing rounds
+
+    @return @c *this
+    */
+    IdlePolicy& max_pause(unsigned pause);
+
+    /**
+    @brief sets the number of stealing rounds in the yield phase
+
+    @return @c *this
+    */
+    IdlePolicy& yield_rounds(unsigned rounds);
+
+    /**
+    @brief sets the maximum number of workers in the spin and yield phases
+
+    @return @c *this
+    */
+    IdlePolicy& max_spinners(unsigned spinners);
+
+    /**
+    @brief enables or disables the adaptation of the spin budget
+
+    @return @c *this
+    */
+    IdlePolicy& adaptive(bool flag);
+
+    /**
+    @brief queries the minimum number of stealing rounds in the spin phase
+    */
+    unsigned min_spins() const;
+
+    /**
+    @brief queries the maximum number of stealing rounds in the spin phase
+    */
+    unsigned max_spins() const;
+
+    /**
+    @brief queries the maximum number of @c pause instructions between rounds
+    */
+    unsigned max_pause() const;
+
+    /**
+    @brief queries the number of stealing rounds in the yield phase
+    */
+    unsigned yield_rounds() const;
+
+    /**
+    @brief queries the maximum number of workers in the spin and yield phases
+    */
+    unsigned max_spinners() const;
+
+    /**
+    @brief queries if the spin budget adapts to the steal success rate
+    */
+    bool adaptive() const;
+
+    /**
+    @brief computes the next spin budget from the current one and
+           the outcome of the idle phases
+    */
+    unsigned adapt(unsigned budget, bool found) const;
+
+  private:
+
+    unsigned _min_spins {64};
+    unsigned _max_spins {1024};
+    unsigned _max_pause {16};
+    unsigned _yield_rounds {8};
+    unsigned _max_spinners {1};
+    bool _adaptive {true};
+};
+
+/**
+@struct: IdleStats
+
+@brief Counters of the idle phases of the workers in an executor
+*/
+struct IdleStats {
+  size_t num_spins {0};       ///< stealing rounds in the spin phase
+  size_t num_yields {0};      ///< stealing rounds in the yield phase
+  size_t num_idle_steals {0}; ///< successful steals in the spin and yield phases
+  size_t num_sleeps {0};      ///< times a worker went to sleep
+};
+
+// Function: latency
+inline IdlePolicy IdlePolicy::latency() {
+  return IdlePolicy().spin_budget(4096, 65536)
+                     .max_pause(64)
+                     .yield_rounds(256)
+                     .max_spinners(2);
+}
+
+// Function: power_saving
+inline IdlePolicy IdlePolicy::power_saving() {
+  return IdlePolicy().spin_budget(0, 16)
+                     .max_pause(1)
+                     .yield_rounds(0);
+}
+
+// Function: spin_budget
+inline IdlePolicy& IdlePolicy::spin_budget(unsigned min, unsigned max) {
+  _min_spins = std::min(min, max);
+  _max_spins = max;
+  return *this;
+}
+
+// Function: max_pause
+inline IdlePolicy& IdlePolicy::max_pause(unsigned pause) {
+  _max_pause = std::max(1u, pause);
+  return *this;
+}
+
+// Function: yield_rounds
+inline IdlePolicy& IdlePolicy::yield_rounds(unsigned rounds) {
+  _yield_rounds = rounds;
+  return *this;
+}
+
+// Function: max_spinners
+inline IdlePolicy& IdlePolicy::max_spinners(unsigned spinners) {
+  _max_spinners = spinners;
+  return *this;
+}
+
+// Function: adaptive
+inline IdlePolicy& IdlePolicy::adaptive(bool flag) {
+  _adaptive = flag;
+  return *this;
+}
+
+// Function: min_spins
+inline unsigned IdlePolicy::min_spins() const {
+  return _min_spins;
+}
+
+// Function: max_spins
+inline unsigned IdlePolicy::max_spins() const {
+  return _max_spins;
+}
+
+// Function: max_pause
+inline unsigned IdlePolicy::max_pause() const {
+  return _max_pause;
+}
+
+// Function: yield_rounds
+inline unsigned IdlePolicy::yield_rounds() const {
+  return _yield_rounds;
+}
+
+// Function: max_spinners
+inline unsigned IdlePolicy::max_spinners() const {
+  return _max_spinners;
+}
+
+// Function: adaptive
+inline bool IdlePolicy::adaptive() const {
+  return _adaptive;
+}
+
+// Function: adapt
+inline unsigned IdlePolicy::adapt(unsigned budget, bool found) const {
+  if(!_adaptive) {
+    return _max_spins;
+  }
+  budget = found ? std::max(1u, budget) * 2 : budget / 2;
+  return std::clamp(budget, _min_spins, _max_spins);
+}
+
+}  // end of namespace tf. ---------------------------------------------------
+
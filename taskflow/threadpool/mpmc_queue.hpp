@@ -0,0 +1,208 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <cassert>
+
+namespace tf {
+
+/**
+@class: MPMCQueue
+
+@tparam T data type
+
+@brief Lock-free bounded multiple-producer multiple-consumer queue.
+
+This class implements the bounded queue of Dmitry Vyukov: each cell carries
+a sequence number telling producers and consumers whether the cell is ready
+for them, so a push or a pop claims its position with a single CAS and
+never waits for another thread to finish its operation on another cell.
+*/
+template <typename T>
+class MPMCQueue {
+
+  struct Cell {
+    std::atomic<size_t> sequence;
+    T data;
+  };
+
+  constexpr static size_t cacheline_size = 64;
+
+  alignas(cacheline_size) std::atomic<size_t> _enqueue_pos;
+  alignas(cacheline_size) std::atomic<size_t> _dequeue_pos;
+  alignas(cacheline_size) std::unique_ptr<Cell[]> _cells;
+
+  const size_t _mask;
+
+  public:
+
+    /**
+    @brief constructs the queue with a given capacity
+
+    @param capacity the capacity of the queue (must be power of 2)
+    */
+    explicit MPMCQueue(size_t capacity = 4096);
+
+    /**
+    @brief queries if the queue is empty at the time of this call
+    */
+    bool empty() const noexcept;
+
+    /**
+    @brief queries the number of items at the time of this call
+    */
+    size_t size() const noexcept;
+
+    /**
+    @brief queries the capacity of the queue
+    */
+    size_t capacity() const noexcept;
+
+    /**
+    @brief tries to insert an item to the queue
+
+    Any threads can insert items to the queue.
+    The item is left untouched if the queue is full.
+
+    @tparam O data type
+
+    @param item the item to perfect-forward to the queue
+
+    @return @c true if the item was inserted
+    */
+    template <typename O>
+    bool try_push(O&& item);
+
+    /**
+    @brief inserts an item to the queue, yielding while the queue is full
+
+    @tparam O data type
+
+    @param item the item to perfect-forward to the queue
+    */
+    template <typename O>
+    void push(O&& item);
+
+    /**
+    @brief pops out an item from the queue
+
+    Any threads can pop items from the queue.
+    The return is a @std_nullopt if the queue is empty.
+    */
+    std::optional<T> pop();
+};
+
+// Constructor
+template <typename T>
+MPMCQueue<T>::MPMCQueue(size_t c) :
+  _cells {std::make_unique<Cell[]>(c)},
+  _mask  {c - 1} {
+
+  assert(c >= 2 && (!(c & (c-1))));
+
+  for(size_t i=0; i<c; ++i) {
+    _cells[i].sequence.store(i, std::memory_order_relaxed);
+  }
+  _enqueue_pos.store(0, std::memory_order_relaxed);
+  _dequeue_pos.store(0, std::memory_order_relaxed);
+}
+
+// Function: empty
+template <typename T>
+bool MPMCQueue<T>::empty() const noexcept {
+  return size() == 0;
+}
+
+// Function: size
+template <typename T>
+size_t MPMCQueue<T>::size() const noexcept {
+  size_t d = _dequeue_pos.load(std::memory_order_relaxed);
+  size_t e = _enqueue_pos.load(std::memory_order_relaxed);
+  return e > d ? e - d : 0;
+}
+
+// Function: capacity
+template <typename T>
+size_t MPMCQueue<T>::capacity() const noexcept {
+  return _mask + 1;
+}
+
+// Function: try_push
+template <typename T>
+template <typename O>
+bool MPMCQueue<T>::try_push(O&& o) {
+
+  Cell* cell;
+  size_t pos = _enqueue_pos.load(std::memory_order_relaxed);
+
+  while(true) {
+    cell = &_cells[pos & _mask];
+    size_t seq = cell->sequence.load(std::memory_order_acquire);
+    auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+    // the cell is free for this position
+    if(diff == 0) {
+      if(_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+        break;
+      }
+    }
+    // the cell still holds an item of the previous lap: queue is full
+    else if(diff < 0) {
+      return false;
+    }
+    else {
+      pos = _enqueue_pos.load(std::memory_order_relaxed);
+    }
+  }
+
+  cell->data = std::forward<O>(o);
+  cell->sequence.store(pos + 1, std::memory_order_release);
+
+  return true;
+}
+
+// Procedure: push
+template <typename T>
+template <typename O>
+void MPMCQueue<T>::push(O&& o) {
+  while(!try_push(std::forward<O>(o))) {
+    std::this_thread::yield();
+  }
+}
+
+// Function: pop
+template <typename T>
+std::optional<T> MPMCQueue<T>::pop() {
+
+  Cell* cell;
+  size_t pos = _dequeue_pos.load(std::memory_order_relaxed);
+
+  while(true) {
+    cell = &_cells[pos & _mask];
+    size_t seq = cell->sequence.load(std::memory_order_acquire);
+    auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+    // the cell holds the item of this position
+    if(diff == 0) {
+      if(_dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+        break;
+      }
+    }
+    // the item of this position is not yet published: queue is empty
+    else if(diff < 0) {
+      return std::nullopt;
+    }
+    else {
+      pos = _dequeue_pos.load(std::memory_order_relaxed);
+    }
+  }
+
+  std::optional<T> item {std::move(cell->data)};
+  cell->sequence.store(pos + _mask + 1, std::memory_order_release);
+
+  return item;
+}
+
+}  // end of namespace tf. ---------------------------------------------------
+
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <type_traits>
+#include <utility>
+
+namespace tf {
+
+/**
+@enum TaskPriority
+
+@brief priority levels of a task
+
+A smaller value denotes a more urgent level.
+Executors that support priorities serve all ready closures of a more urgent
+level before any closure of a less urgent one; other executors ignore them.
+@c MAX is the number of levels and not a valid priority itself.
+*/
+enum class TaskPriority : unsigned {
+  HIGH   = 0,
+  NORMAL = 1,
+  LOW    = 2,
+  MAX    = 3
+};
+
+// Struct: has_priority
+// Detects closures that expose a const member function priority().
+template <typename T, typename = void>
+struct has_priority : std::false_type {
+};
+
+template <typename T>
+struct has_priority<T, std::void_t<decltype(std::declval<const T&>().priority())>>
+  : std::true_type {
+};
+
+template <typename T>
+inline constexpr bool has_priority_v = has_priority<T>::value;
+
+}  // end of namespace tf. ---------------------------------------------------
+
@@ -45,6 +45,8 @@
 #include <optional>
 #include <cassert>
 
+#include "cpu_affinity.hpp"
+
 namespace tf {
   
 /**
@@ -71,8 +73,9 @@ class ProactiveThreadpool {
     @brief constructs the executor with a given number of worker threads
 
     @param N the number of worker threads
+    @param affinity the policy to pin the worker threads to processors
     */
-    ProactiveThreadpool(unsigned N);
+    ProactiveThreadpool(unsigned N, const CpuAffinity& affinity = CpuAffinity());
 
     /**
     @brief destructs the executor
@@ -122,13 +125,13 @@ class ProactiveThreadpool {
     bool _exiting {false};
     
     void _shutdown();
-    void _spawn(unsigned);
+    void _spawn(unsigned, const CpuAffinity&);
 };
     
 // Constructor
 template <typename Closure>
-ProactiveThreadpool<Closure>::ProactiveThreadpool(unsigned N){
-  _spawn(N);
+ProactiveThreadpool<Closure>::ProactiveThreadpool(unsigned N, const CpuAffinity& affinity){
+  _spawn(N, affinity);
 }
 
 // Destructor
@@ -179,13 +182,17 @@ void ProactiveThreadpool<Closure>::_shutdown() {
 
 // Procedure: spawn
 template <typename Closure>
-void ProactiveThreadpool<Closure>::_spawn(unsigned N) {
+void ProactiveThreadpool<Closure>::_spawn(unsigned N, const CpuAffinity& affinity) {
 
   assert(is_owner());
 
+  auto cpusets = affinity.cpusets(N);
+
   for(size_t i=0; i<N; ++i){
   
-    _threads.emplace_back([this] () -> void {
+    _threads.emplace_back([this, cpus=std::move(cpusets[i])] () -> void {
+
+      bind_this_thread(cpus);
       
       Worker w;
       
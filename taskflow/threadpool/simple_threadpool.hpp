@@ -36,6 +36,8 @@
 #include <cassert>
 #include <unordered_set>
 
+#include "cpu_affinity.hpp"
+
 namespace tf {
 
 /**
@@ -55,8 +57,9 @@ class SimpleThreadpool {
     @brief constructs the executor with a given number of worker threads
     
     @param N the number of worker threads
+    @param affinity the policy to pin the worker threads to processors
     */
-    explicit SimpleThreadpool(unsigned N);
+    explicit SimpleThreadpool(unsigned N, const CpuAffinity& affinity = CpuAffinity());
 
     /**
     @brief destructs the executor
@@ -105,14 +108,14 @@ class SimpleThreadpool {
     
     bool _stop {false};
 
-    void _spawn(unsigned);
+    void _spawn(unsigned, const CpuAffinity&);
     void _shutdown();
 };
 
 // Constructor
 template <typename Closure>
-SimpleThreadpool<Closure>::SimpleThreadpool(unsigned N) {
-  _spawn(N);
+SimpleThreadpool<Closure>::SimpleThreadpool(unsigned N, const CpuAffinity& affinity) {
+  _spawn(N, affinity);
 }
 
 // Destructor
@@ -136,13 +139,17 @@ bool SimpleThreadpool<Closure>::is_owner() const {
 // The procedure spawns "n" threads monitoring the task queue and executing each task. 
 // After the task is finished, the thread reacts to the returned signal.
 template <typename Closure>
-void SimpleThreadpool<Closure>::_spawn(unsigned N) {
+void SimpleThreadpool<Closure>::_spawn(unsigned N, const CpuAffinity& affinity) {
 
   assert(is_owner());
+
+  auto cpusets = affinity.cpusets(N);
     
   for(size_t i=0; i<N; ++i) {
       
-    _threads.emplace_back([this] () -> void { 
+    _threads.emplace_back([this, cpus=std::move(cpusets[i])] () -> void { 
+
+      bind_this_thread(cpus);
         
       Closure task;
           
@@ -38,6 +38,8 @@
 #include <optional>
 #include <cassert>
 
+#include "cpu_affinity.hpp"
+
 namespace tf {
 
 /**
@@ -63,8 +65,9 @@ class SpeculativeThreadpool {
     @brief constructs the executor with a given number of worker threads
 
     @param N the number of worker threads
+    @param affinity the policy to pin the worker threads to processors
     */
-    SpeculativeThreadpool(unsigned N);
+    SpeculativeThreadpool(unsigned N, const CpuAffinity& affinity = CpuAffinity());
 
     /**
     @brief destructs the executor
@@ -118,15 +121,15 @@ class SpeculativeThreadpool {
     auto _this_worker() const;
     
     void _shutdown();
-    void _spawn(unsigned);
+    void _spawn(unsigned, const CpuAffinity&);
 
 };  // class BasicSpeculativeThreadpool. --------------------------------------
 
 // Constructor
 template <typename Closure>
-SpeculativeThreadpool<Closure>::SpeculativeThreadpool(unsigned N) : 
+SpeculativeThreadpool<Closure>::SpeculativeThreadpool(unsigned N, const CpuAffinity& affinity) : 
   _workers {N} {
-  _spawn(N);
+  _spawn(N, affinity);
 }
 
 // Destructor
@@ -186,16 +189,20 @@ void SpeculativeThreadpool<Closure>::_shutdown(){
 
 // Function: spawn 
 template <typename Closure>
-void SpeculativeThreadpool<Closure>::_spawn(unsigned N) {
+void SpeculativeThreadpool<Closure>::_spawn(unsigned N, const CpuAffinity& affinity) {
 
   assert(is_owner() && _workers.size() == N);
 
+  auto cpusets = affinity.cpusets(N);
+
   // Lock to synchronize all workers before creating _worker_mapss
   std::scoped_lock lock(_mutex);
 
   for(size_t i=0; i<N; ++i){
 
-    _threads.emplace_back([this, &w=_workers[i]]() -> void {
+    _threads.emplace_back([this, &w=_workers[i], cpus=std::move(cpusets[i])]() -> void {
+
+       bind_this_thread(cpus);
 
        std::optional<Closure> t;
 
@@ -22,7 +22,14 @@
 
 #pragma once
 
+#include <array>
+#include <chrono>
+
 #include "notifier.hpp"
+#include "mpmc_queue.hpp"
+#include "cpu_affinity.hpp"
+#include "priority.hpp"
+#include "idle_policy.hpp"
 
 namespace tf {
 
@@ -37,6 +44,12 @@ This class implements the work stealing queue described in the paper,
 "Dynamic Circular Work-stealing Deque," SPAA, 2015.
 Only the queue owner can perform pop and push operations,
 while others can steal data from the queue.
+
+Arrays retired by a resize are reclaimed by the owner as soon as no thief
+is in the middle of a steal, so the memory of the queue is bounded by
+its current capacity rather than by its largest burst. 
+The owner can also shrink the array back to its initial capacity 
+once the queue drains.
 */
 template <typename T>
 class WorkStealingQueue {
@@ -98,7 +111,9 @@ class WorkStealingQueue {
   std::atomic<int64_t> _top;
   std::atomic<int64_t> _bottom;
   std::atomic<Array*> _array;
+  std::atomic<int64_t> _num_thieves;
   std::vector<Array*> _garbage;
+  int64_t _min_capacity;
   //char _padding[cacheline_size];
 
   public:
@@ -159,14 +174,52 @@ class WorkStealingQueue {
     The return can be a @std_nullopt if this operation failed (not necessary empty).
     */
     std::optional<T> steal();
+
+    /**
+    @brief steals up to half of the items from the queue
+
+    The first stolen item is returned and the others are pushed to 
+    the queue @c dst, which must be owned by the caller. 
+    Each item is claimed by its own CAS: claiming a range of items at once
+    would race with the owner, who pops without a CAS unless only one item
+    is left.
+
+    @param dst the queue of the caller to receive the extra items
+    @param max the maximum number of items to steal
+
+    @return a @std_nullopt if no item was stolen
+    */
+    std::optional<T> steal_batch(WorkStealingQueue& dst, size_t max);
+
+    /**
+    @brief shrinks the queue to its initial capacity if it is empty
+
+    Only the owner thread can shrink the queue.
+
+    @return @c true if the capacity was reduced
+    */
+    bool shrink();
+
+    /**
+    @brief queries the number of retired arrays not yet reclaimed
+
+    Only the owner thread can call this method.
+    */
+    size_t num_retired() const noexcept;
+
+  private:
+
+    void _retire(Array*);
+    void _reclaim();
 };
 
 // Constructor
 template <typename T>
-WorkStealingQueue<T>::WorkStealingQueue(int64_t c) {
+WorkStealingQueue<T>::WorkStealingQueue(int64_t c) : _min_capacity {c} {
   assert(c && (!(c & (c-1))));
   _top.store(0, std::memory_order_relaxed);
   _bottom.store(0, std::memory_order_relaxed);
+  _num_thieves.store(0, std::memory_order_relaxed);
   _array.store(new Array{c}, std::memory_order_relaxed);
   _garbage.reserve(32);
 }
@@ -207,9 +260,13 @@ void WorkStealingQueue<T>::push(O&& o) {
   // queue is full
   if(a->capacity() - 1 < (b - t)) {
     Array* tmp = a->resize(b, t);
-    _garbage.push_back(a);
     std::swap(a, tmp);
-    _array.store(a, std::memory_order_relaxed);
+    _retire(tmp);
+    _array.store(a, std::memory_order_seq_cst);
+  }
+
+  if(!_garbage.empty()) {
+    _reclaim();
   }
 
   a->push(b, std::forward<O>(o));
@@ -250,25 +307,102 @@ std::optional<T> WorkStealingQueue<T>::pop() {
 // Function: steal
 template <typename T>
 std::optional<T> WorkStealingQueue<T>::steal() {
+
   int64_t t = _top.load(std::memory_order_acquire);
   std::atomic_thread_fence(std::memory_order_seq_cst);
   int64_t b = _bottom.load(std::memory_order_acquire);
   
   std::optional<T> item;
 
+  // Only a thief that reads the array announces itself, before loading 
+  // it, so the owner will not reclaim the array; a probe of an empty 
+  // queue touches no shared counter.
   if(t < b) {
-    Array* a = _array.load(std::memory_order_consume);
+    _num_thieves.fetch_add(1, std::memory_order_seq_cst);
+    Array* a = _array.load(std::memory_order_seq_cst);
     item = a->pop(t);
     if(!_top.compare_exchange_strong(t, t+1,
                                      std::memory_order_seq_cst,
                                      std::memory_order_relaxed)) {
-      return std::nullopt;
+      item = std::nullopt;
     }
+    _num_thieves.fetch_sub(1, std::memory_order_release);
   }
 
   return item;
 }
 
+// Function: steal_batch
+template <typename T>
+std::optional<T> WorkStealingQueue<T>::steal_batch(WorkStealingQueue& dst, size_t max) {
+
+  auto n = std::min(static_cast<int64_t>(max), (size() + 1) / 2);
+
+  auto item = steal();
+
+  if(!item) {
+    return std::nullopt;
+  }
+
+  while(--n > 0) {
+    if(auto extra = steal(); extra) {
+      dst.push(std::move(*extra));
+    }
+    else break;
+  }
+
+  return item;
+}
+
+// Function: shrink
+template <typename T>
+bool WorkStealingQueue<T>::shrink() {
+
+  if(!_garbage.empty()) {
+    _reclaim();
+  }
+
+  Array* a = _array.load(std::memory_order_relaxed);
+
+  if(a->capacity() <= _min_capacity || !empty()) {
+    return false;
+  }
+
+  // The queue stays empty until the owner pushes again and thieves 
+  // index the array by the same top/bottom counters.
+  _array.store(new Array{_min_capacity}, std::memory_order_seq_cst);
+  _retire(a);
+  _reclaim();
+
+  return true;
+}
+
+// Function: num_retired
+template <typename T>
+size_t WorkStealingQueue<T>::num_retired() const noexcept {
+  return _garbage.size();
+}
+
+// Procedure: _retire
+template <typename T>
+void WorkStealingQueue<T>::_retire(Array* a) {
+  _garbage.push_back(a);
+}
+
+// Procedure: _reclaim
+// Frees the retired arrays if no thief is in flight. A thief that 
+// announces itself after this check loads the latest array, which is 
+// published (seq_cst) before the check.
+template <typename T>
+void WorkStealingQueue<T>::_reclaim() {
+  if(_num_thieves.load(std::memory_order_seq_cst) == 0) {
+    for(auto a : _garbage) {
+      delete a;
+    }
+    _garbage.clear();
+  }
+}
+
 // Function: capacity
 template <typename T>
 int64_t WorkStealingQueue<T>::capacity() const noexcept {
@@ -282,21 +416,65 @@ int64_t WorkStealingQueue<T>::capacity() const noexcept {
 
 @brief Executor that implements an efficient work stealing algorithm.
 
+Workers are grouped by the locality domains (e.g., NUMA nodes) of 
+the machine and each worker is bound to the processors of its domain,
+or to the processors given by a user-specified affinity policy.
+A thief first steals from the workers in its own domain and crosses
+the domain boundary only after a number of failed stealing rounds.
+
+If the closure type provides a member function @c priority() convertible
+to @c unsigned (e.g., a TaskPriority), each worker keeps one queue per
+priority level and both popping and stealing serve a more urgent level
+before any less urgent one. Levels beyond TaskPriority::MAX are clamped.
+Until a closure of another level than TaskPriority::NORMAL is scheduled,
+workers probe the normal level only.
+
+Workers without work follow an IdlePolicy that spins, yields, and then 
+sleeps until new closures arrive.
+
+A thread that waits for closures of this executor can call run_one() to
+run pending closures itself instead of blocking.
+
+The number of active workers can change at runtime, up to the number given
+at construction, either explicitly through resize() or in the elastic mode, 
+where the last active worker retires after it has been idle for a timeout 
+and retired workers are brought back while all active ones keep stealing work.
+
 @tparam Closure closure type
 */
 template <typename Closure>
 class WorkStealingThreadpool {
     
+  // closures without priorities share a single level
+  constexpr static unsigned NUM_LEVELS = 
+    has_priority_v<Closure> ? static_cast<unsigned>(TaskPriority::MAX) : 1;
+
+  // consecutive successful steals with no sleeping worker before 
+  // the elastic mode brings back a retired worker
+  constexpr static size_t GROWTH_STEALS = 64;
+
   struct Worker {
-    WorkStealingQueue<Closure> queue;
+    std::array<WorkStealingQueue<Closure>, NUM_LEVELS> queues;
     std::optional<Closure> cache;
-    bool exit  {false};
-    unsigned last_victim;
+    std::atomic<bool> exit {false};
+    unsigned domain {0};
+    unsigned last_victim {0};
+    unsigned num_failed_steals {0};
+    uint64_t seed;
+    std::vector<unsigned> cpus;
+    std::atomic<size_t> num_steals {0};
+    std::atomic<size_t> num_cross_domain_steals {0};
+    unsigned spin_budget {0};
+    std::atomic<size_t> num_spins {0};
+    std::atomic<size_t> num_yields {0};
+    std::atomic<size_t> num_idle_steals {0};
+    std::atomic<size_t> num_sleeps {0};
   };
     
   struct PerThread {
     WorkStealingThreadpool* pool {nullptr}; 
     int thread_id {-1};
+    unsigned last_victim {0};
   };
   
   public:
@@ -304,9 +482,31 @@ class WorkStealingThreadpool {
     /**
     @brief constructs the executor with a given number of worker threads
 
+    The workers are spread evenly over the locality domains, and a thief
+    steals from workers in its own domain first. No worker is pinned;
+    use the constructor taking a tf::CpuAffinity to pin them.
+
+    @param N the number of worker threads
+    @param topology the locality domains to group the workers
+    */
+    explicit WorkStealingThreadpool(
+      unsigned N, const CpuTopology& topology = CpuTopology::system()
+    );
+
+    /**
+    @brief constructs the executor with a given number of worker threads
+           pinned by an affinity policy
+
+    Workers are grouped by the domains of the processors they are pinned to.
+    Unpinned workers are spread evenly over the domains of the policy's topology.
+
     @param N the number of worker threads
+    @param affinity the policy to pin the worker threads to processors
+    @param idle the policy of the workers waiting for work
     */
-    explicit WorkStealingThreadpool(unsigned N);
+    WorkStealingThreadpool(
+      unsigned N, const CpuAffinity& affinity, const IdlePolicy& idle = IdlePolicy()
+    );
 
     /**
     @brief destructs the executor
@@ -317,9 +517,48 @@ class WorkStealingThreadpool {
     ~WorkStealingThreadpool();
     
     /**
-    @brief queries the number of worker threads
+    @brief queries the number of active worker threads
     */
     size_t num_workers() const;
+
+    /**
+    @brief queries the maximum number of worker threads, 
+           i.e., the number given at construction
+    */
+    size_t max_workers() const;
+
+    /**
+    @brief sets the number of active worker threads and leaves the elastic mode
+
+    Growing starts the threads of retired workers; shrinking lets the 
+    retired workers finish the closures in their own queues and joins 
+    their threads. When no worker remains, the closures pending in the 
+    executor run on the calling thread and new closures run immediately,
+    as in an executor without workers. This method must not be called by 
+    a worker of this executor.
+
+    @param N the number of active workers, clamped to max_workers()
+    */
+    void resize(size_t N);
+
+    /**
+    @brief enters the elastic mode
+
+    In this mode, the last active worker retires after it found no work 
+    for the given timeout, until @c min_workers (at least one) workers 
+    remain, and retired
+    workers come back when all active ones keep stealing work without 
+    any of them sleeping.
+
+    @param min_workers the minimum number of active workers
+    @param timeout the time a worker stays idle before it retires
+    */
+    void elastic(size_t min_workers, std::chrono::milliseconds timeout);
+
+    /**
+    @brief queries if the executor is in the elastic mode
+    */
+    bool elastic() const;
     
     /**
     @brief queries if the caller is the owner of the executor
@@ -343,24 +582,116 @@ class WorkStealingThreadpool {
     */
     void batch(std::vector<Closure>& closures);
 
+    /**
+    @brief runs at most one pending closure on the calling thread
+
+    Lets a thread that waits for closures of this executor help the workers
+    instead of blocking. A worker of this executor runs the next closure of
+    its own queues or steals one; any other thread takes one from the 
+    centralized queues or steals one from a worker.
+
+    @return @c true if a closure was run
+    */
+    bool run_one();
+    
+    /**
+    @brief queries the number of locality domains the workers are grouped into
+    */
+    size_t num_domains() const;
+
+    /**
+    @brief sets the number of consecutive failed stealing rounds 
+           in its own domain before a thief crosses to other domains
+    */
+    void cross_domain_rounds(unsigned rounds);
+    
+    /**
+    @brief queries the number of failed stealing rounds before crossing domains
+    */
+    unsigned cross_domain_rounds() const;
+
+    /**
+    @brief sets the maximum number of closures a thief takes from a victim
+           in one steal (at most half of the victim's closures)
+
+    A value of one disables batch stealing.
+    */
+    void max_steal_batch(size_t max);
+
+    /**
+    @brief queries the maximum number of closures taken in one steal
+    */
+    size_t max_steal_batch() const;
+
+    /**
+    @brief queries the number of closures stolen from other workers so far
+    */
+    size_t num_steals() const;
+    
+    /**
+    @brief queries the number of closures stolen from workers 
+           in other domains so far
+    */
+    size_t num_cross_domain_steals() const;
+
+    /**
+    @brief queries the idle policy of the workers
+    */
+    const IdlePolicy& idle_policy() const;
+
+    /**
+    @brief queries the counters of the idle phases of all workers so far
+    */
+    IdleStats idle_stats() const;
+
   private:
     
     const std::thread::id _owner {std::this_thread::get_id()};
 
-    std::mutex _mutex;
-
     std::vector<Worker> _workers;
     std::vector<std::thread> _threads;
     std::vector<Notifier::Waiter> _waiters;
+    std::vector<std::vector<unsigned>> _domains;
+
+    const IdlePolicy _idle_policy;
 
-    WorkStealingQueue<Closure> _queue;
+    std::array<MPMCQueue<Closure>, NUM_LEVELS> _queues;
     
     Notifier _notifier;
     
     std::atomic<size_t> _num_idlers {0};
-    std::atomic<bool> _spinning {false};
+    std::atomic<unsigned> _num_spinners {0};
+    std::atomic<unsigned> _cross_domain_rounds {4};
+    std::atomic<size_t> _max_steal_batch {32};
+    std::atomic<bool> _prioritized {false};
+
+    std::mutex _mutex;
+    std::atomic<bool> _stop {false};
+    std::atomic<size_t> _num_active;
+    std::atomic<bool> _elastic {false};
+    std::atomic<size_t> _min_workers {0};
+    std::atomic<int64_t> _retire_timeout {0};
+    std::atomic<size_t> _pressure {0};
+    
+    std::atomic<bool> _lingering {false};
+    std::mutex _linger_mutex;
+    std::condition_variable _linger_cv;
+    size_t _linger_epoch {0};
 
     void _spawn(unsigned);
+    void _notify(bool);
+    void _grow();
+    bool _lingerable(unsigned);
+    void _push(Worker&, Closure&&);
+    void _push_central(Closure&&);
+    void _run(Worker&, std::optional<Closure>&);
+
+    unsigned _priority(const Closure&);
+    std::pair<unsigned, unsigned> _levels() const;
+
+    std::optional<Closure> _pop(Worker&);
+    std::optional<Closure> _pop_central();
+    std::optional<Closure> _steal_central(Worker&, unsigned);
 
     unsigned _randomize(uint64_t&) const;
     unsigned _fast_modulo(unsigned, unsigned) const;
@@ -368,33 +699,96 @@ class WorkStealingThreadpool {
     PerThread& _per_thread() const;
 
     std::optional<Closure> _steal(unsigned);
+    std::optional<Closure> _idle(unsigned);
+    std::optional<Closure> _linger(unsigned);
+    std::optional<Closure> _steal_from(
+      unsigned, unsigned, const std::vector<unsigned>&, unsigned&
+    );
 };
 
 // Constructor
 template <typename Closure>
-WorkStealingThreadpool<Closure>::WorkStealingThreadpool(unsigned N) : 
-  _workers {N},
-  _waiters {N},
-  _notifier{_waiters} {
+WorkStealingThreadpool<Closure>::WorkStealingThreadpool(
+  unsigned N, const CpuTopology& topology
+) : 
+  WorkStealingThreadpool(N, CpuAffinity(CpuAffinity::NONE, topology)) {
+}
+
+// Constructor
+template <typename Closure>
+WorkStealingThreadpool<Closure>::WorkStealingThreadpool(
+  unsigned N, const CpuAffinity& affinity, const IdlePolicy& idle
+) : 
+  _workers     {N},
+  _threads     {N},
+  _waiters     {N},
+  _idle_policy {idle},
+  _notifier    {_waiters},
+  _num_active  {N} {
+
+  const auto& topology = affinity.topology();
+  
+  auto cpusets = affinity.cpusets(N);
+  
+  // pinned workers join the domain of their processors and unpinned 
+  // workers are spread evenly over the domains
+  const size_t D = std::min(topology.num_domains(), std::max(size_t{1}, size_t{N}));
+
+  std::vector<std::vector<unsigned>> groups(topology.num_domains());
+
+  for(unsigned i=0; i<N; ++i) {
+    auto d = cpusets[i].empty() ? i * D / N : topology.domain_of(cpusets[i].front());
+    groups[d].push_back(i);
+    _workers[i].cpus = std::move(cpusets[i]);
+    _workers[i].seed = i + 1;
+    _workers[i].spin_budget = _idle_policy.max_spins();
+  }
+
+  // drop the domains no worker belongs to
+  for(auto& g : groups) {
+    if(g.empty()) {
+      continue;
+    }
+    for(auto i : g) {
+      _workers[i].domain = static_cast<unsigned>(_domains.size());
+      _workers[i].last_victim = static_cast<unsigned>(
+        (std::find(g.begin(), g.end(), i) - g.begin() + 1) % g.size()
+      );
+    }
+    _domains.push_back(std::move(g));
+  }
+
+  if(_domains.empty()) {
+    _domains.emplace_back();
+  }
 
-  _spawn(N);
+  for(unsigned i=0; i<N; ++i) {
+    _spawn(i);
+  }
 }
 
 // Destructor
+// Stops the elastic mode under the mutex so that no worker can be inside 
+// _grow respawning a thread while the threads are joined below.
 template <typename Closure>
 WorkStealingThreadpool<Closure>::~WorkStealingThreadpool() {
 
   {
     std::scoped_lock lock(_mutex);
-    for(auto& w : _workers){
-      w.exit = true;
-    }
-  } 
+    _elastic = false;
+    _stop = true;
+  }
+
+  for(auto& w : _workers){
+    w.exit = true;
+  }
   
-  _notifier.notify(true);
+  _notify(true);
 
   for(auto& t : _threads){
-    t.join();
+    if(t.joinable()) {
+      t.join();
+    }
   } 
 }
 
@@ -422,90 +816,368 @@ unsigned WorkStealingThreadpool<Closure>::_fast_modulo(unsigned x, unsigned N) c
 }
 
 // Procedure: _spawn
+// Starts the thread of the worker in the given slot, unless the pool is
+// being destroyed.
 template <typename Closure>
-void WorkStealingThreadpool<Closure>::_spawn(unsigned N) {
+void WorkStealingThreadpool<Closure>::_spawn(unsigned i) {
+
+  if(_stop) {
+    return;
+  }
   
-  // Lock to synchronize all workers before creating _worker_mapss
-  for(unsigned i=0; i<N; ++i) {
-    _threads.emplace_back([this, i, N] () -> void {
+  _workers[i].exit = false;
 
-      PerThread& pt = _per_thread();  
-      pt.pool = this;
-      pt.thread_id = i;
-    
-      auto& waiter = _waiters[i];
-      auto& worker = _workers[i];
+  _threads[i] = std::thread([this, i] () -> void {
+
+    PerThread& pt = _per_thread();  
+    pt.pool = this;
+    pt.thread_id = i;
+  
+    auto& waiter = _waiters[i];
+    auto& worker = _workers[i];
 
-      worker.last_victim = (i + 1) % N;
+    bind_this_thread(worker.cpus);
 
-      std::optional<Closure> t;
+    std::optional<Closure> t;
 
-      while(!worker.exit) {
+    while(!worker.exit) {
 
-        // pop from my own queue
-        if(t = worker.queue.pop(); !t) {
-          // steal from others
-          t = _steal(i);
+      // pop from my own queues
+      if(t = _pop(worker); !t) {
+        // steal from others
+        if(t = _steal(i); t && _elastic.load(std::memory_order_relaxed)) {
+          _grow();
         }
+      }
+      
+      // Leave a few threads to spin to reduce the latency
+      if(!t && _num_spinners.load(std::memory_order_relaxed) < _idle_policy.max_spinners()) {
+        if(_num_spinners.fetch_add(1) < _idle_policy.max_spinners()) {
+          t = _idle(i);
+        }
+        _num_spinners.fetch_sub(1);
+      }
+      
+      // Now we are going to preempt this worker thread
+      if(!t) {
         
-        // Leave one thread to spin to reduce the latency
-        if (!t && !_spinning && !_spinning.exchange(true)) {
-          for(int r = 0; r < 1024 && !worker.exit && !t; r++) {
-            t = _steal(i);
-          }
-          _spinning = false;
+        _notifier.prepare_wait(&waiter);
+
+        bool commit {true};
+
+        // Re-check the exit flag and the centralized queues after 
+        // announcing the wait; producers push before they notify, 
+        // so either we see the closure here or we get the notification.
+        if(worker.exit) {
+          commit = false;
+        }
+        else if(t = _pop_central(); t) {
+          commit = false;
         }
         
-        // Now we are going to preempt this worker thread
-        if(!t) {
-          
-          _notifier.prepare_wait(&waiter);
-
-          bool commit {true};
-
-          if(_mutex.try_lock()) {
-            if(worker.exit) {
-              commit = false;
-            }
-            else {
-              if(!_queue.empty()) {
-                commit = false;
-                t = _queue.pop();
-              }
-            }
-            _mutex.unlock();
-          }
-          else {
-            commit = false;
-          }
-          
-          // commit the wait if the flag is on
-          if(commit) {
-            _num_idlers++;
-            _notifier.commit_wait(&waiter);
-            _num_idlers--;
-          }
-          else {
-            _notifier.cancel_wait(&waiter);
+        // release the memory of a past burst before sleeping; arrays a 
+        // thief may still read are reclaimed when the worker next pushes 
+        // or comes back here
+        if(commit) {
+          for(auto& q : worker.queues) {
+            q.shrink();
           }
         }
+        
+        // the last active worker in the elastic mode waits for 
+        // the retire timeout instead
+        if(commit && _lingerable(i)) {
+          _notifier.cancel_wait(&waiter);
+          t = _linger(i);
+        }
+        // commit the wait if the flag is on
+        else if(commit) {
+          worker.num_sleeps.fetch_add(1, std::memory_order_relaxed);
+          _pressure.store(0, std::memory_order_relaxed);
+          _num_idlers++;
+          _notifier.commit_wait(&waiter);
+          _num_idlers--;
+        }
+        else {
+          _notifier.cancel_wait(&waiter);
+        }
+      }
 
-        while(t) {
-          (*t)();
-          if(worker.cache) {
-            t = std::move(worker.cache);
-            worker.cache = std::nullopt;
-          }
-          else {
-            t = std::nullopt;
+      _run(worker, t);
+    } // End of while ------------------------------------------------------ 
+
+    // a retired worker finishes its own closures and lets the new last
+    // active worker re-evaluate its retirement
+    if(!_stop) {
+      std::optional<Closure> t;
+      while((t = _pop(worker))) {
+        _run(worker, t);
+      }
+      _notifier.notify(true);
+    }
+  });     
+}
+
+// Procedure: _run
+// Runs a closure and then the closures the worker caches along the way.
+template <typename Closure>
+void WorkStealingThreadpool<Closure>::_run(Worker& worker, std::optional<Closure>& t) {
+  while(t) {
+    (*t)();
+    if(worker.cache) {
+      t = std::move(worker.cache);
+      worker.cache = std::nullopt;
+      // yield to more urgent closures queued before the cached one
+      if constexpr(NUM_LEVELS > 1) {
+        auto p = _priority(*t);
+        for(unsigned l=_levels().first; l<p; ++l) {
+          if(!worker.queues[l].empty()) {
+            worker.queues[p].push(std::move(*t));
+            t = _pop(worker);
+            break;
           }
         }
-      } // End of while ------------------------------------------------------ 
+      }
+    }
+    else {
+      t = std::nullopt;
+    }
+  }
+}
+
+// Function: run_one
+// A worker serves its own queues first, exactly as in its scheduling loop.
+// Any other thread takes from the centralized queues and then steals one
+// closure from the workers, level by level, without a queue of its own to
+// batch into; closures it creates go to the centralized queues.
+template <typename Closure>
+bool WorkStealingThreadpool<Closure>::run_one() {
+
+  if(num_workers() == 0) {
+    return false;
+  }
+
+  auto& pt = _per_thread();
+
+  std::optional<Closure> t;
+
+  if(pt.pool == this) {
+    auto& worker = _workers[pt.thread_id];
+    if(worker.cache) {
+      t = std::move(worker.cache);
+      worker.cache = std::nullopt;
+    }
+    else if(t = _pop(worker); !t) {
+      t = _steal(pt.thread_id);
+    }
+    if(!t) {
+      return false;
+    }
+    _run(worker, t);
+    return true;
+  }
+
+  if(t = _pop_central(); !t) {
+    const auto N = static_cast<unsigned>(_workers.size());
+    const auto [lb, le] = _levels();
+    for(unsigned l=lb; l<le && !t; ++l) {
+      for(unsigned i=0; i<N; ++i) {
+        if(++pt.last_victim >= N) {
+          pt.last_victim = 0;
+        }
+        if(t = _workers[pt.last_victim].queues[l].steal(); t) {
+          break;
+        }
+      }
+    }
+  }
 
-    });     
+  if(!t) {
+    return false;
+  }
+
+  (*t)();
+
+  return true;
+}
+
+// Procedure: _notify
+// Wakes up sleeping workers and the lingering worker, if any. Producers 
+// push before they notify, so a lingering worker either finds the closure
+// when it re-checks the queues or observes the new epoch.
+template <typename Closure>
+void WorkStealingThreadpool<Closure>::_notify(bool all) {
+  _notifier.notify(all);
+  if(_lingering.load()) {
+    {
+      std::scoped_lock lock(_linger_mutex);
+      ++_linger_epoch;
+    }
+    _linger_cv.notify_one();
   }
 }
 
+// Function: _lingerable
+// Claims the lingering role for the last active worker in the elastic mode.
+template <typename Closure>
+bool WorkStealingThreadpool<Closure>::_lingerable(unsigned i) {
+  
+  if(!_elastic.load(std::memory_order_relaxed)) {
+    return false;
+  }
+
+  auto n = _num_active.load();
+
+  if(i + 1 != n || n <= _min_workers.load(std::memory_order_relaxed)) {
+    return false;
+  }
+
+  bool expected {false};
+  return _lingering.compare_exchange_strong(expected, true);
+}
+
+// Function: _linger
+// Waits for new closures up to the retire timeout and retires the worker
+// if none arrive. The retirement gives up if a resize is in progress.
+template <typename Closure>
+std::optional<Closure> WorkStealingThreadpool<Closure>::_linger(unsigned i) {
+  
+  auto& worker = _workers[i];
+
+  std::optional<Closure> t;
+
+  std::unique_lock<std::mutex> lock(_linger_mutex);
+  auto epoch = _linger_epoch;
+  lock.unlock();
+
+  if(t = _steal(i); !t && !worker.exit) {
+    
+    lock.lock();
+    bool woken = _linger_cv.wait_for(
+      lock, 
+      std::chrono::milliseconds(_retire_timeout.load(std::memory_order_relaxed)),
+      [&] () { return _linger_epoch != epoch; }
+    );
+    lock.unlock();
+
+    if(!woken) {
+      std::unique_lock<std::mutex> guard(_mutex, std::try_to_lock);
+      if(guard && _elastic && !worker.exit && i + 1 == _num_active && 
+         _num_active > _min_workers) {
+        _num_active = i;
+        worker.exit = true;
+      }
+    }
+  }
+
+  _lingering = false;
+
+  return t;
+}
+
+// Procedure: _grow
+// Brings back the first retired worker once the active workers have kept
+// stealing work for a while with none of them sleeping or lingering.
+template <typename Closure>
+void WorkStealingThreadpool<Closure>::_grow() {
+
+  if(_num_idlers.load(std::memory_order_relaxed) != 0 || 
+     _lingering.load(std::memory_order_relaxed) ||
+     _num_active.load(std::memory_order_relaxed) == _workers.size()) {
+    _pressure.store(0, std::memory_order_relaxed);
+    return;
+  }
+
+  if(_pressure.fetch_add(1, std::memory_order_relaxed) + 1 < GROWTH_STEALS) {
+    return;
+  }
+
+  std::unique_lock<std::mutex> lock(_mutex, std::try_to_lock);
+
+  if(!lock || !_elastic || _stop) {
+    return;
+  }
+
+  _pressure.store(0, std::memory_order_relaxed);
+  
+  if(auto n = _num_active.load(); n < _workers.size()) {
+    if(_threads[n].joinable()) {
+      _threads[n].join();
+    }
+    _spawn(static_cast<unsigned>(n));
+    _num_active = n + 1;
+  }
+}
+
+// Procedure: resize
+template <typename Closure>
+void WorkStealingThreadpool<Closure>::resize(size_t N) {
+
+  std::scoped_lock lock(_mutex);
+
+  _elastic = false;
+
+  N = std::min(N, _workers.size());
+  
+  auto n = _num_active.load();
+
+  if(N > n) {
+    for(auto i=n; i<N; ++i) {
+      if(_threads[i].joinable()) {
+        _threads[i].join();
+      }
+      _spawn(static_cast<unsigned>(i));
+    }
+    _num_active = N;
+  }
+  else if(N < n) {
+    _num_active = N;
+    for(auto i=N; i<n; ++i) {
+      _workers[i].exit = true;
+    }
+    _notify(true);
+    for(auto i=N; i<n; ++i) {
+      _threads[i].join();
+    }
+  }
+
+  // run the pending closures if no worker is left; a producer that pushes
+  // after this drain sees no worker and drains the queue itself
+  if(N == 0) {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    while(auto t = _pop_central()) {
+      (*t)();
+    }
+  }
+}
+
+// Procedure: elastic
+template <typename Closure>
+void WorkStealingThreadpool<Closure>::elastic(
+  size_t min_workers, std::chrono::milliseconds timeout
+) {
+  {
+    std::scoped_lock lock(_mutex);
+    _min_workers = std::min(std::max(min_workers, size_t{1}), _workers.size());
+    _retire_timeout = timeout.count();
+    _elastic = true;
+  }
+  // let the last active worker start lingering
+  _notify(true);
+}
+
+// Function: elastic
+template <typename Closure>
+bool WorkStealingThreadpool<Closure>::elastic() const {
+  return _elastic.load(std::memory_order_relaxed);
+}
+
+// Function: max_workers
+template <typename Closure>
+size_t WorkStealingThreadpool<Closure>::max_workers() const {
+  return _workers.size();
+}
+
 // Function: is_owner
 template <typename Closure>
 bool WorkStealingThreadpool<Closure>::is_owner() const {
@@ -515,40 +1187,337 @@ bool WorkStealingThreadpool<Closure>::is_owner() const {
 // Function: num_workers
 template <typename Closure>
 size_t WorkStealingThreadpool<Closure>::num_workers() const { 
-  return _workers.size();  
+  return _num_active.load(std::memory_order_relaxed);  
 }
 
-// Function: _steal
+// Function: num_domains
 template <typename Closure>
-std::optional<Closure> WorkStealingThreadpool<Closure>::_steal(unsigned thief) {
+size_t WorkStealingThreadpool<Closure>::num_domains() const {
+  return _domains.size();
+}
 
-  std::optional<Closure> task;
+// Procedure: cross_domain_rounds
+template <typename Closure>
+void WorkStealingThreadpool<Closure>::cross_domain_rounds(unsigned rounds) {
+  _cross_domain_rounds.store(rounds, std::memory_order_relaxed);
+}
+
+// Function: cross_domain_rounds
+template <typename Closure>
+unsigned WorkStealingThreadpool<Closure>::cross_domain_rounds() const {
+  return _cross_domain_rounds.load(std::memory_order_relaxed);
+}
+
+// Procedure: max_steal_batch
+template <typename Closure>
+void WorkStealingThreadpool<Closure>::max_steal_batch(size_t max) {
+  _max_steal_batch.store(std::max(size_t{1}, max), std::memory_order_relaxed);
+}
+
+// Function: max_steal_batch
+template <typename Closure>
+size_t WorkStealingThreadpool<Closure>::max_steal_batch() const {
+  return _max_steal_batch.load(std::memory_order_relaxed);
+}
+
+// Function: num_steals
+template <typename Closure>
+size_t WorkStealingThreadpool<Closure>::num_steals() const {
+  size_t n {0};
+  for(const auto& w : _workers) {
+    n += w.num_steals.load(std::memory_order_relaxed);
+  }
+  return n;
+}
+
+// Function: num_cross_domain_steals
+template <typename Closure>
+size_t WorkStealingThreadpool<Closure>::num_cross_domain_steals() const {
+  size_t n {0};
+  for(const auto& w : _workers) {
+    n += w.num_cross_domain_steals.load(std::memory_order_relaxed);
+  }
+  return n;
+}
+
+// Function: idle_policy
+template <typename Closure>
+const IdlePolicy& WorkStealingThreadpool<Closure>::idle_policy() const {
+  return _idle_policy;
+}
+
+// Function: idle_stats
+template <typename Closure>
+IdleStats WorkStealingThreadpool<Closure>::idle_stats() const {
+  IdleStats stats;
+  for(const auto& w : _workers) {
+    stats.num_spins += w.num_spins.load(std::memory_order_relaxed);
+    stats.num_yields += w.num_yields.load(std::memory_order_relaxed);
+    stats.num_idle_steals += w.num_idle_steals.load(std::memory_order_relaxed);
+    stats.num_sleeps += w.num_sleeps.load(std::memory_order_relaxed);
+  }
+  return stats;
+}
+
+// Function: _idle
+// Runs the spin and yield phases of the idle policy and adapts the spin
+// budget of the worker to the outcome.
+template <typename Closure>
+std::optional<Closure> WorkStealingThreadpool<Closure>::_idle(unsigned i) {
+
+  auto& worker = _workers[i];
+
+  std::optional<Closure> t;
+
+  unsigned r {0};
+
+  // spin phase with exponential backoff
+  for(unsigned pause = 1; r < worker.spin_budget && !worker.exit; ++r) {
+    if(t = _steal(i); t) {
+      ++r;
+      break;
+    }
+    for(unsigned k=0; k<pause; ++k) {
+      relax_cpu();
+    }
+    pause = std::min(pause * 2, _idle_policy.max_pause());
+  }
+  worker.num_spins.fetch_add(r, std::memory_order_relaxed);
   
-  // try getting a task from the centralized queue
-  if(task = _queue.steal(); task) {
-    return task;
+  // yield phase
+  if(!t) {
+    for(r = 0; r < _idle_policy.yield_rounds() && !worker.exit; ) {
+      std::this_thread::yield();
+      ++r;
+      if(t = _steal(i); t) {
+        break;
+      }
+    }
+    worker.num_yields.fetch_add(r, std::memory_order_relaxed);
+  }
+
+  if(t) {
+    worker.num_idle_steals.fetch_add(1, std::memory_order_relaxed);
   }
 
-  // try stealing a task from other workers
-  unsigned victim = _workers[thief].last_victim;
+  worker.spin_budget = _idle_policy.adapt(worker.spin_budget, t.has_value());
 
-  for(unsigned i=0; i<_workers.size(); i++){
+  return t;
+}
+
+// Function: _steal_from
+// Tries each victim in the list once, starting from the cursor position.
+// The cursor is left at the successful victim.
+template <typename Closure>
+std::optional<Closure> WorkStealingThreadpool<Closure>::_steal_from(
+  unsigned thief, unsigned level, const std::vector<unsigned>& victims, unsigned& cursor
+) {
 
-    if(victim != thief) {
-      if(task = _workers[victim].queue.steal(); task){
-        _workers[thief].last_victim = victim;
+  std::optional<Closure> task;
+
+  for(size_t i=0; i<victims.size(); i++){
+
+    if(auto victim = victims[cursor]; victim != thief) {
+      if(task = _workers[victim].queues[level].steal_batch(
+          _workers[thief].queues[level], _max_steal_batch.load(std::memory_order_relaxed)
+        ); task){
         return task;
       }
     }
 
-    if(++victim; victim == _workers.size()){
-      victim = 0;
+    if(++cursor; cursor == victims.size()){
+      cursor = 0;
+    }
+  }
+  
+  return std::nullopt; 
+}
+
+// Function: _steal
+// Serves the levels from the most urgent one. Within each level, a thief
+// tries the centralized queue and the workers in its own domain first.
+template <typename Closure>
+std::optional<Closure> WorkStealingThreadpool<Closure>::_steal(unsigned thief) {
+
+  std::optional<Closure> task;
+  
+  auto& worker = _workers[thief];
+
+  const auto [lb, le] = _levels();
+
+  for(unsigned l=lb; l<le; ++l) {
+
+    // try getting a task from the centralized queue
+    if(task = _steal_central(worker, l); task) {
+      return task;
+    }
+
+    // try stealing a task from other workers in the same domain
+    if(task = _steal_from(thief, l, _domains[worker.domain], worker.last_victim); task) {
+      worker.num_failed_steals = 0;
+      worker.num_steals.fetch_add(1, std::memory_order_relaxed);
+      return task;
+    }
+  }
+
+  // cross the domain boundary after enough failed rounds
+  if(_domains.size() > 1 && 
+     ++worker.num_failed_steals > _cross_domain_rounds.load(std::memory_order_relaxed)) {
+
+    for(unsigned l=lb; l<le; ++l) {
+      for(size_t i=1; i<_domains.size(); ++i) {
+
+        auto& victims = _domains[(worker.domain + i) % _domains.size()];
+        auto cursor = _fast_modulo(
+          _randomize(worker.seed), static_cast<unsigned>(victims.size())
+        );
+
+        if(task = _steal_from(thief, l, victims, cursor); task) {
+          worker.num_failed_steals = 0;
+          worker.num_steals.fetch_add(1, std::memory_order_relaxed);
+          worker.num_cross_domain_steals.fetch_add(1, std::memory_order_relaxed);
+          return task;
+        }
+      }
     }
   }
   
   return std::nullopt; 
 }
 
+// Function: _priority
+// Maps a closure to the index of its level queue. The first closure of a 
+// level other than the normal one makes the workers probe all levels; it
+// is marked before the closure is queued, so a worker that finds it has 
+// seen the mark.
+template <typename Closure>
+unsigned WorkStealingThreadpool<Closure>::_priority(const Closure& c) {
+  if constexpr(NUM_LEVELS > 1) {
+    auto p = std::min(static_cast<unsigned>(c.priority()), NUM_LEVELS - 1);
+    if(p != static_cast<unsigned>(TaskPriority::NORMAL) && 
+       !_prioritized.load(std::memory_order_relaxed)) {
+      _prioritized.store(true);
+    }
+    return p;
+  }
+  else {
+    return 0;
+  }
+}
+
+// Function: _levels
+// Returns the range of levels that may hold closures: the normal level
+// only, until a closure of another level has been scheduled.
+template <typename Closure>
+std::pair<unsigned, unsigned> WorkStealingThreadpool<Closure>::_levels() const {
+  if constexpr(NUM_LEVELS > 1) {
+    if(!_prioritized.load(std::memory_order_relaxed)) {
+      constexpr auto normal = static_cast<unsigned>(TaskPriority::NORMAL);
+      return {normal, normal + 1};
+    }
+  }
+  return {0, NUM_LEVELS};
+}
+
+// Function: _pop
+// Pops a closure from the most urgent non-empty queue of the worker.
+template <typename Closure>
+std::optional<Closure> WorkStealingThreadpool<Closure>::_pop(Worker& worker) {
+  const auto [lb, le] = _levels();
+  for(unsigned l=lb; l<le; ++l) {
+    if(auto t = worker.queues[l].pop(); t) {
+      return t;
+    }
+  }
+  return std::nullopt;
+}
+
+// Function: _pop_central
+// Pops a closure from the most urgent non-empty centralized queue.
+template <typename Closure>
+std::optional<Closure> WorkStealingThreadpool<Closure>::_pop_central() {
+  const auto [lb, le] = _levels();
+  for(unsigned l=lb; l<le; ++l) {
+    if(auto t = _queues[l].pop(); t) {
+      return t;
+    }
+  }
+  return std::nullopt;
+}
+
+// Function: _steal_central
+// Pops a closure from the centralized queue of the given level and moves
+// up to half of the remaining ones (bounded by the steal batch) into the 
+// worker's own queue. The batch is sized after the pop, since the size of
+// the queue is only a hint and may miss closures pushed concurrently.
+template <typename Closure>
+std::optional<Closure> WorkStealingThreadpool<Closure>::_steal_central(
+  Worker& worker, unsigned l
+) {
+
+  auto task = _queues[l].pop();
+
+  if(!task) {
+    return std::nullopt;
+  }
+
+  auto n = std::min(_max_steal_batch.load(std::memory_order_relaxed), (_queues[l].size() + 2) / 2);
+
+  while(n-- > 1) {
+    if(auto extra = _queues[l].pop(); extra) {
+      worker.queues[l].push(std::move(*extra));
+    }
+    else break;
+  }
+
+  return task;
+}
+
+// Procedure: _push
+// Inserts a closure created by the worker itself. The cache slot always
+// keeps the most urgent closure so it runs right after the current one.
+template <typename Closure>
+void WorkStealingThreadpool<Closure>::_push(Worker& worker, Closure&& c) {
+
+  if(!worker.cache) {
+    worker.cache.emplace(std::move(c));
+    return;
+  }
+
+  if constexpr(NUM_LEVELS > 1) {
+    if(_priority(c) < _priority(*worker.cache)) {
+      std::swap(c, *worker.cache);
+    }
+  }
+
+  worker.queues[_priority(c)].push(std::move(c));
+}
+
+// Procedure: _push_central
+// Inserts a closure created by an external thread. When the queue is full,
+// the producer wakes up a worker to drain it and retries. The pool may
+// have been resized to no worker since the producer checked, in which case
+// the producer runs the closure or drains the queue itself, since no one
+// else will.
+template <typename Closure>
+void WorkStealingThreadpool<Closure>::_push_central(Closure&& c) {
+  auto& queue = _queues[_priority(c)];
+  while(!queue.try_push(std::move(c))) {
+    if(num_workers() == 0) {
+      c();
+      return;
+    }
+    _notify(false);
+    std::this_thread::yield();
+  }
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if(_num_active.load(std::memory_order_relaxed) == 0) {
+    while(auto t = _pop_central()) {
+      (*t)();
+    }
+  }
+}
+
 // Procedure: emplace
 template <typename Closure>
 template <typename... ArgsT>
@@ -564,21 +1533,21 @@ void WorkStealingThreadpool<Closure>::emplace(ArgsT&&... args){
   
   // caller is a worker to this pool
   if(pt.pool == this) {
-    if(!_workers[pt.thread_id].cache) {
-      _workers[pt.thread_id].cache.emplace(std::forward<ArgsT>(args)...);
+    auto& worker = _workers[pt.thread_id];
+    if(!worker.cache) {
+      worker.cache.emplace(std::forward<ArgsT>(args)...);
       return;
     }
     else {
-      _workers[pt.thread_id].queue.push(Closure{std::forward<ArgsT>(args)...});
+      _push(worker, Closure{std::forward<ArgsT>(args)...});
     }
   }
   // other threads
   else {
-    std::scoped_lock lock(_mutex);
-    _queue.push(Closure{std::forward<ArgsT>(args)...});
+    _push_central(Closure{std::forward<ArgsT>(args)...});
   }
 
-  _notifier.notify(false);
+  _notify(false);
 }
 
 // Procedure: batch
@@ -601,26 +1570,21 @@ void WorkStealingThreadpool<Closure>::batch(std::vector<Closure>& tasks) {
 
   if(pt.pool == this) {
     
-    size_t i = 0;
+    auto& worker = _workers[pt.thread_id];
 
-    if(!_workers[pt.thread_id].cache) {
-      _workers[pt.thread_id].cache = std::move(tasks[i++]);
-    }
-
-    for(; i<tasks.size(); ++i) {
-      _workers[pt.thread_id].queue.push(std::move(tasks[i]));
-      _notifier.notify(false);
+    for(size_t i=0; i<tasks.size(); ++i) {
+      bool cached = !worker.cache;
+      _push(worker, std::move(tasks[i]));
+      if(!cached) {
+        _notify(false);
+      }
     }
 
     return;
   }
   
-  {
-    std::scoped_lock lock(_mutex);
-
-    for(size_t k=0; k<tasks.size(); ++k) {
-      _queue.push(std::move(tasks[k]));
-    }
+  for(size_t k=0; k<tasks.size(); ++k) {
+    _push_central(std::move(tasks[k]));
   }
 
   // We need to wake up at least one thread because _num_idlers may not be
@@ -628,7 +1592,7 @@ void WorkStealingThreadpool<Closure>::batch(std::vector<Closure>& tasks) {
   size_t N = std::max(size_t{1}, std::min(_num_idlers.load(), tasks.size()));
 
   for(size_t i=0; i<N; ++i) {
-    _notifier.notify(false);
+    _notify(false);
   }
 } 
 
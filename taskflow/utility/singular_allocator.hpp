@@ -63,7 +63,7 @@ struct SingularMempool {
   ~SingularMempool() {
     for(auto* prev = head; head!=nullptr;) {
       head = head->next;
-      std::free(prev->block);
+      ::operator delete(prev->block, std::align_val_t{alignof(T)});
       std::free(prev);
       prev = head;
     }
@@ -71,7 +71,8 @@ struct SingularMempool {
 
   MemBlock* allocate_memblock(size_t n) {
     MemBlock* ptr = static_cast<MemBlock*>(std::malloc(sizeof(MemBlock)));
-    ptr->block = static_cast<T*>(std::malloc(n*sizeof(T)));
+    // honor over-aligned types such as the cache-line-aligned Node
+    ptr->block = static_cast<T*>(::operator new(n*sizeof(T), std::align_val_t{alignof(T)}));
     ptr->size = n;
     ptr->next = nullptr;
     return ptr;
@@ -83,19 +83,6 @@ struct is_iterable<T, std::void_t<decltype(std::declval<T>().begin()),
 template <typename T>
 inline constexpr bool is_iterable_v = is_iterable<T>::value;
 
-// Struct: MoC
-// Move-on-copy wrapper.
-template <typename T>
-struct MoC {
-
-  MoC(T&& rhs) : object(std::move(rhs)) {}
-  MoC(const MoC& other) : object(std::move(other.object)) {}
-
-  T& get() { return object; }
-  
-  mutable T object; 
-};
-
 //-----------------------------------------------------------------------------
 // Functors.
 //-----------------------------------------------------------------------------
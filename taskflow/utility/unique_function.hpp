@@ -0,0 +1,194 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace tf {
+
+// Class: UniqueFunction
+// A move-only type-erased callable. Callables up to S bytes that can be
+// moved without throwing are stored in an inline buffer; larger ones are
+// allocated on the heap. Unlike std::function, the callable does not need
+// to be copyable, so it may capture move-only objects such as unique_ptr.
+template <typename F, size_t S = 48>
+class UniqueFunction;
+
+template <typename R, typename... ArgsT, size_t S>
+class UniqueFunction<R(ArgsT...), S> {
+
+  template <typename C>
+  constexpr static bool is_inline_v =
+    sizeof(C) <= S &&
+    alignof(C) <= alignof(std::max_align_t) &&
+    std::is_nothrow_move_constructible_v<C>;
+
+  struct VTable {
+    R (*invoke)(void*, ArgsT&&...);
+    void (*move)(void*, void*) noexcept;
+    void (*destroy)(void*) noexcept;
+  };
+
+  union Storage {
+    alignas(std::max_align_t) unsigned char buffer[S];
+    void* heap;
+  };
+
+  template <typename C>
+  static C* _target(void* s) noexcept {
+    if constexpr(is_inline_v<C>) {
+      return std::launder(reinterpret_cast<C*>(static_cast<Storage*>(s)->buffer));
+    }
+    else {
+      return static_cast<C*>(static_cast<Storage*>(s)->heap);
+    }
+  }
+
+  template <typename C>
+  static R _invoke(void* s, ArgsT&&... args) {
+    // a void function discards the result of the callable, as std::function
+    if constexpr(std::is_void_v<R>) {
+      std::invoke(*_target<C>(s), std::forward<ArgsT>(args)...);
+    }
+    else {
+      return std::invoke(*_target<C>(s), std::forward<ArgsT>(args)...);
+    }
+  }
+
+  template <typename C>
+  static void _move(void* dst, void* src) noexcept {
+    if constexpr(is_inline_v<C>) {
+      C* c = _target<C>(src);
+      ::new (static_cast<Storage*>(dst)->buffer) C(std::move(*c));
+      c->~C();
+    }
+    else {
+      static_cast<Storage*>(dst)->heap = static_cast<Storage*>(src)->heap;
+    }
+  }
+
+  template <typename C>
+  static void _destroy(void* s) noexcept {
+    if constexpr(is_inline_v<C>) {
+      _target<C>(s)->~C();
+    }
+    else {
+      delete _target<C>(s);
+    }
+  }
+
+  template <typename C>
+  inline static const VTable _vtable_of {&_invoke<C>, &_move<C>, &_destroy<C>};
+
+  template <typename C>
+  using enable_if_callable_t = std::enable_if_t<
+    !std::is_same_v<std::decay_t<C>, UniqueFunction> &&
+    !std::is_same_v<std::decay_t<C>, std::nullptr_t> &&
+    std::is_invocable_r_v<R, std::decay_t<C>&, ArgsT...>
+  >;
+
+  public:
+
+    UniqueFunction() noexcept = default;
+    UniqueFunction(std::nullptr_t) noexcept {}
+
+    template <typename C, typename = enable_if_callable_t<C>>
+    UniqueFunction(C&& c) {
+      _emplace(std::forward<C>(c));
+    }
+
+    UniqueFunction(UniqueFunction&& rhs) noexcept {
+      _steal(rhs);
+    }
+
+    UniqueFunction(const UniqueFunction&) = delete;
+
+    ~UniqueFunction() {
+      _reset();
+    }
+
+    UniqueFunction& operator = (UniqueFunction&& rhs) noexcept {
+      if(this != &rhs) {
+        _reset();
+        _steal(rhs);
+      }
+      return *this;
+    }
+
+    UniqueFunction& operator = (const UniqueFunction&) = delete;
+
+    UniqueFunction& operator = (std::nullptr_t) noexcept {
+      _reset();
+      return *this;
+    }
+
+    template <typename C, typename = enable_if_callable_t<C>>
+    UniqueFunction& operator = (C&& c) {
+      _reset();
+      _emplace(std::forward<C>(c));
+      return *this;
+    }
+
+    R operator ()(ArgsT... args) const {
+      if(_vtable == nullptr) {
+        throw std::bad_function_call();
+      }
+      return _vtable->invoke(&_storage, std::forward<ArgsT>(args)...);
+    }
+
+    explicit operator bool () const noexcept {
+      return _vtable != nullptr;
+    }
+
+    friend bool operator == (const UniqueFunction& f, std::nullptr_t) noexcept {
+      return f._vtable == nullptr;
+    }
+
+    friend bool operator != (const UniqueFunction& f, std::nullptr_t) noexcept {
+      return f._vtable != nullptr;
+    }
+
+    // queries if a callable of type C is stored without a heap allocation
+    template <typename C>
+    constexpr static bool stores_inline() {
+      return is_inline_v<std::decay_t<C>>;
+    }
+
+  private:
+
+    mutable Storage _storage;
+
+    const VTable* _vtable {nullptr};
+
+    template <typename C>
+    void _emplace(C&& c) {
+      using T = std::decay_t<C>;
+      if constexpr(is_inline_v<T>) {
+        ::new (_storage.buffer) T(std::forward<C>(c));
+      }
+      else {
+        _storage.heap = new T(std::forward<C>(c));
+      }
+      _vtable = &_vtable_of<T>;
+    }
+
+    void _steal(UniqueFunction& rhs) noexcept {
+      if(rhs._vtable) {
+        rhs._vtable->move(&_storage, &rhs._storage);
+        _vtable = rhs._vtable;
+        rhs._vtable = nullptr;
+      }
+    }
+
+    void _reset() noexcept {
+      if(_vtable) {
+        _vtable->destroy(&_storage);
+        _vtable = nullptr;
+      }
+    }
+};
+
+}  // end of namespace tf. ---------------------------------------------------
+
@@ -5,6 +5,8 @@
 #include <taskflow/taskflow.hpp>
 #include <vector>
 #include <utility>
+#include <set>
+#include <random>
 #include <chrono>
 #include <limits.h>
 
@@ -44,6 +46,22 @@ TEST_CASE("Executor" * doctest::timeout(300)) {
     REQUIRE(executor.use_count() == 5);
   }
 
+  SUBCASE("Affinity Executor") {
+    for(unsigned t=0; t<=4; ++t) {
+      tf::Taskflow tf(t, tf::CpuAffinity::compact());
+      std::atomic<int> counter {0};
+      auto [A, B, C] = tf.emplace(
+        [&] () { counter++; },
+        [&] () { counter++; },
+        [&] () { counter++; }
+      );
+      A.precede(B, C);
+      tf.wait_for_all();
+      REQUIRE(counter == 3);
+      REQUIRE(tf.num_workers() == t);
+    }
+  }
+
   SUBCASE("Shared Dispatch") {
     
     for(int t=0; t<=4; ++t) {
@@ -517,6 +535,370 @@ TEST_CASE("ParallelForOnIndex" * doctest::timeout(300)) {
 
 }
 
+// --------------------------------------------------------
+// Testcase: ParallelForPartitioner
+// --------------------------------------------------------
+TEST_CASE("ParallelForPartitioner" * doctest::timeout(300)) {
+
+  std::vector<tf::Partitioner> partitioners;
+  for(size_t g : {0, 1, 7}) {
+    partitioners.push_back(tf::StaticPartitioner(g));
+    partitioners.push_back(tf::DynamicPartitioner(g));
+    partitioners.push_back(tf::GuidedPartitioner(g));
+    partitioners.push_back(tf::AutoPartitioner(g));
+  }
+
+  // every element is visited exactly once in each of the repeated runs
+  for(unsigned W=0; W<=4; ++W) {
+    tf::Taskflow tf(W);
+    for(const auto& p : partitioners) {
+      for(size_t N : {0, 1, 2, 17, 1000}) {
+
+        tf::Framework f;
+        std::vector<int> vec(N, 0);
+        std::list<int> lst(N, 0);
+        std::vector<std::atomic<int>> pos(N), neg(N), flt(N);
+
+        f.parallel_for(vec.begin(), vec.end(), [] (int& v) { ++v; }, p);
+        f.parallel_for(lst.begin(), lst.end(), [] (int& v) { ++v; }, p);
+        f.parallel_for(0, static_cast<int>(N), 1, [&] (int i) { pos[i]++; }, p);
+        f.parallel_for(static_cast<int>(N)-1, -1, -1, [&] (int i) { neg[i]++; }, p);
+        f.parallel_for(0.0, N/2.0, 0.5, [&] (double i) { 
+          flt[static_cast<size_t>(i*2.0 + 0.5)]++; 
+        }, p);
+
+        for(int r=1; r<=3; ++r) {
+          tf.run(f).get();
+          for(size_t i=0; i<N; ++i) {
+            REQUIRE(vec[i] == r);
+            REQUIRE(pos[i] == r);
+            REQUIRE(neg[i] == r);
+            REQUIRE(flt[i] == r);
+          }
+          for(auto v : lst) {
+            REQUIRE(v == r);
+          }
+        }
+      }
+    }
+  }
+
+  // skewed per-element cost
+  for(unsigned W=1; W<=4; ++W) {
+    tf::Taskflow tf(W);
+    for(const auto& p : partitioners) {
+      std::atomic<size_t> sum {0};
+      tf.parallel_for(0, 200, 1, [&] (int i) {
+        size_t local = 0;
+        for(int k=0; k<(i < 10 ? 10000 : 10); ++k) {
+          local += k;
+        }
+        sum += local;
+      }, p);
+      tf.wait_for_all();
+      REQUIRE(sum == 10 * (10000ul*9999/2) + 190 * (10*9/2));
+    }
+  }
+
+  REQUIRE_THROWS(tf::Taskflow().parallel_for(0, 10, -1, [] (int) {}, tf::DynamicPartitioner()));
+  REQUIRE_THROWS(tf::Taskflow().parallel_for(0.0, 1.0, 0.0, [] (double) {}, tf::GuidedPartitioner()));
+}
+
+// --------------------------------------------------------
+// Testcase: Parallelism
+// --------------------------------------------------------
+TEST_CASE("Parallelism" * doctest::timeout(300)) {
+
+  const size_t N = 1000;
+
+  for(unsigned W=0; W<=4; ++W) {
+
+    // a taskflow partitions for its own workers when the graph is built
+    tf::Taskflow tf(W);
+    REQUIRE(tf.parallelism() == std::max(1u, W));
+
+    std::vector<int> vec(N, 0);
+    tf.parallel_for(vec.begin(), vec.end(), [] (int& v) { ++v; });
+    REQUIRE(tf.num_nodes() == 2 + std::max(1u, W));
+
+    size_t parallelism = 0;
+    tf.emplace([&] (tf::SubflowBuilder& sf) { parallelism = sf.parallelism(); });
+    tf.wait_for_all();
+    REQUIRE(parallelism == std::max(1u, W));
+    for(auto v : vec) {
+      REQUIRE(v == 1);
+    }
+
+    // a framework partitions when it runs, on whichever taskflow runs it
+    tf::Framework f;
+    REQUIRE(f.parallelism() == 0);
+
+    int sum = 0, tsum = 0, psum = 0;
+    std::vector<std::atomic<int>> idx(N);
+    const std::vector<int> data(N, 1);
+
+    f.parallel_for(vec.begin(), vec.end(), [] (int& v) { ++v; });
+    f.parallel_for(0, static_cast<int>(N), 1, [&] (int i) { idx[i]++; });
+    f.parallel_for(0, static_cast<int>(N), 1, [&] (int i) { idx[i]++; }, 
+                   tf::DynamicPartitioner());
+    f.reduce(data.begin(), data.end(), sum, std::plus<int>());
+    f.transform_reduce(data.begin(), data.end(), tsum, std::plus<int>(), 
+                       [] (int v) { return 2*v; });
+    f.transform_reduce(data.begin(), data.end(), psum, std::plus<int>(), 
+                       [] (int s, int v) { return s + v; }, [] (int v) { return v; });
+    REQUIRE(f.num_nodes() == 6 * 3);
+    
+    tf::Taskflow tf1(W), tf2(W + 1);
+    tf1.run(f).get();
+    tf2.run(f).get();
+    for(size_t i=0; i<N; ++i) {
+      REQUIRE(vec[i] == 3);
+      REQUIRE(idx[i] == 4);
+    }
+    REQUIRE(sum  == 2*N);
+    REQUIRE(tsum == 4*N);
+    REQUIRE(psum == 2*N);
+  }
+
+  // a taskflow partitions for the workers its executor has when the graph
+  // is built, including after the executor is resized
+  {
+    tf::Taskflow tf(4);
+    std::vector<int> vec(N, 0);
+
+    tf.share_executor()->resize(1);
+    REQUIRE(tf.parallelism() == 1);
+    tf.parallel_for(vec.begin(), vec.end(), [] (int& v) { ++v; });
+    REQUIRE(tf.num_nodes() == 2 + 1);
+
+    tf.share_executor()->resize(3);
+    REQUIRE(tf.parallelism() == 3);
+    tf.parallel_for(vec.begin(), vec.end(), [] (int& v) { ++v; });
+    REQUIRE(tf.num_nodes() == (2 + 1) + (2 + 3));
+
+    tf.share_executor()->resize(0);
+    REQUIRE(tf.parallelism() == 1);
+    tf.sort(vec.begin(), vec.end());
+
+    tf.share_executor()->resize(4);
+    tf.wait_for_all();
+    for(auto v : vec) {
+      REQUIRE(v == 2);
+    }
+  }
+}
+
+// --------------------------------------------------------
+// Testcase: LazyRange
+// --------------------------------------------------------
+TEST_CASE("LazyRange" * doctest::timeout(300)) {
+
+  for(unsigned W=0; W<=4; ++W) {
+
+    tf::Taskflow tf(W);
+    tf::Framework f;
+
+    std::vector<int> vec;
+    std::list<int> lst;
+    int beg = 0, end = 0, sum = 0, min = 0, max = 0, tsum = 0, psum = 0;
+    std::vector<std::atomic<int>> pos(64), neg(64);
+
+    // the parallel_fors precede the reductions over the same containers
+    auto [S1, T1] = f.parallel_for(std::ref(vec), [] (int& v) { v *= 2; });
+    auto [S2, T2] = f.parallel_for(std::ref(lst), [] (int& v) { v *= 2; }, 
+                                   tf::GuidedPartitioner());
+    auto [S3, T3] = f.reduce(std::cref(vec), sum, std::plus<int>());
+    auto [S4, T4] = f.reduce_min(std::cref(vec), min);
+    auto [S5, T5] = f.reduce_max(std::cref(vec), max);
+    auto [S6, T6] = f.transform_reduce(std::cref(lst), tsum, std::plus<int>(), 
+                                       [] (int v) { return v + 1; });
+    auto [S7, T7] = f.transform_reduce(std::cref(lst), psum, std::plus<int>(), 
+      [] (int s, int v) { return s + v; }, [] (int v) { return v; }
+    );
+    f.parallel_for(std::cref(beg), std::cref(end), 1, [&] (int i) { pos[i]++; });
+    f.parallel_for(std::cref(end), std::cref(beg), -1, [&] (int i) { neg[i-1]++; });
+    f.parallel_for(std::cref(beg), std::cref(end), -1, [&] (int) { REQUIRE(false); });
+
+    T1.precede(S3, S4, S5);
+    T2.precede(S6, S7);
+
+    // the batch grows and shrinks between runs of the same framework
+    for(int n : {0, 1, 5, 64, 17, 3, 0, 40}) {
+
+      vec.resize(n);
+      lst.resize(n);
+      std::iota(vec.begin(), vec.end(), 1);
+      std::iota(lst.begin(), lst.end(), 1);
+      beg = 0;
+      end = n;
+      sum = tsum = psum = 0;
+      min = std::numeric_limits<int>::max();
+      max = std::numeric_limits<int>::min();
+      for(auto& p : pos) p = 0;
+      for(auto& p : neg) p = 0;
+
+      tf.run(f).get();
+
+      int expected = 0;
+      for(int i=0; i<n; ++i) {
+        REQUIRE(vec[i] == 2*(i+1));
+        REQUIRE(pos[i] == 1);
+        REQUIRE(neg[i] == 1);
+        expected += 2*(i+1);
+      }
+      for(int i=n; i<64; ++i) {
+        REQUIRE(pos[i] == 0);
+        REQUIRE(neg[i] == 0);
+      }
+      REQUIRE(sum == expected);
+      REQUIRE(tsum == expected + n);
+      REQUIRE(psum == expected);
+      if(n > 0) {
+        REQUIRE(min == 2);
+        REQUIRE(max == 2*n);
+      }
+    }
+  }
+
+  tf::Framework f;
+  int beg = 0, end = 10;
+  REQUIRE_THROWS(f.parallel_for(std::ref(beg), std::ref(end), 0, [] (int) {}));
+}
+
+// --------------------------------------------------------
+// Testcase: Scan
+// --------------------------------------------------------
+TEST_CASE("Scan" * doctest::timeout(300)) {
+
+  auto square = [] (int v) { return v * v; };
+
+  for(unsigned W=0; W<=4; ++W) {
+    for(size_t N : {0, 1, 2, 3, 10, 1000, 4097}) {
+
+      tf::Taskflow tf(W);
+
+      std::vector<int> in(N), inc(N), exc(N), tinc(N), texc(N), inplace(N);
+      std::vector<int> inc_ref(N), exc_ref(N), tinc_ref(N), texc_ref(N);
+      std::iota(in.begin(), in.end(), -100);
+      inplace = in;
+
+      std::list<int> lin(in.begin(), in.end()), lout(N);
+
+      tf.inclusive_scan(in.begin(), in.end(), inc.begin(), std::plus<int>());
+      tf.exclusive_scan(in.begin(), in.end(), exc.begin(), 7, std::plus<int>());
+      tf.transform_inclusive_scan(in.begin(), in.end(), tinc.begin(), std::plus<int>(), square);
+      tf.transform_exclusive_scan(in.begin(), in.end(), texc.begin(), -3, std::plus<int>(), square);
+      tf.inclusive_scan(inplace.begin(), inplace.end(), inplace.begin(), std::plus<int>());
+      tf.exclusive_scan(lin.begin(), lin.end(), lout.begin(), 1, std::plus<int>());
+      tf.wait_for_all();
+
+      std::inclusive_scan(in.begin(), in.end(), inc_ref.begin(), std::plus<int>());
+      std::exclusive_scan(in.begin(), in.end(), exc_ref.begin(), 7, std::plus<int>());
+      std::transform_inclusive_scan(in.begin(), in.end(), tinc_ref.begin(), std::plus<int>(), square);
+      std::transform_exclusive_scan(in.begin(), in.end(), texc_ref.begin(), -3, std::plus<int>(), square);
+
+      REQUIRE(inc == inc_ref);
+      REQUIRE(exc == exc_ref);
+      REQUIRE(tinc == tinc_ref);
+      REQUIRE(texc == texc_ref);
+      REQUIRE(inplace == inc_ref);
+
+      std::vector<int> lref(N);
+      std::exclusive_scan(in.begin(), in.end(), lref.begin(), 1, std::plus<int>());
+      REQUIRE(std::equal(lout.begin(), lout.end(), lref.begin()));
+    }
+  }
+
+  // a non-commutative operator keeps the order of items, and a framework 
+  // rescans on every run
+  for(unsigned W=0; W<=4; ++W) {
+
+    tf::Taskflow tf(W);
+    tf::Framework f;
+
+    std::vector<std::string> in(300), out(300), ref(300);
+    for(size_t i=0; i<in.size(); ++i) {
+      in[i] = std::string(1, static_cast<char>('a' + i % 26));
+    }
+    
+    f.exclusive_scan(in.begin(), in.end(), out.begin(), std::string(">"), std::plus<std::string>());
+    std::exclusive_scan(in.begin(), in.end(), ref.begin(), std::string(">"), std::plus<std::string>());
+
+    for(int r=0; r<3; ++r) {
+      std::fill(out.begin(), out.end(), "");
+      tf.run(f).get();
+      REQUIRE(out == ref);
+    }
+  }
+}
+
+// --------------------------------------------------------
+// Testcase: Sort
+// --------------------------------------------------------
+TEST_CASE("Sort" * doctest::timeout(300)) {
+
+  std::mt19937 gen(0);
+
+  for(unsigned W=0; W<=4; ++W) {
+    for(size_t N : {0, 1, 2, 100, 4095, 4096, 10000, 65537}) {
+
+      tf::Taskflow tf(W);
+
+      std::vector<int> vec(N), ref;
+      for(auto& v : vec) {
+        v = static_cast<int>(gen() % 1000);
+      }
+      ref = vec;
+      std::sort(ref.begin(), ref.end());
+
+      // default comparator
+      auto a = vec;
+      tf.sort(a.begin(), a.end());
+
+      // custom comparator on records
+      std::vector<std::pair<int, size_t>> recs(N);
+      for(size_t i=0; i<N; ++i) {
+        recs[i] = {vec[i], i};
+      }
+      tf.sort(recs.begin(), recs.end(), [] (const auto& l, const auto& r) {
+        return l.first > r.first;
+      });
+
+      // move-only items through a scratch buffer
+      std::vector<std::unique_ptr<int>> ptrs(N), scratch(N);
+      for(size_t i=0; i<N; ++i) {
+        ptrs[i] = std::make_unique<int>(vec[i]);
+      }
+      tf.sort(ptrs.begin(), ptrs.end(), scratch.begin(), [] (const auto& l, const auto& r) {
+        return *l < *r;
+      });
+
+      tf.wait_for_all();
+
+      REQUIRE(a == ref);
+      for(size_t i=0; i<N; ++i) {
+        REQUIRE(recs[i].first == ref[N-1-i]);
+        REQUIRE(*ptrs[i] == ref[i]);
+      }
+    }
+  }
+
+  // a framework sorts again on every run
+  for(unsigned W=0; W<=4; ++W) {
+    tf::Taskflow tf(W);
+    tf::Framework f;
+    std::vector<double> vec(20000);
+    f.sort(vec.begin(), vec.end());
+    for(int r=0; r<3; ++r) {
+      for(auto& v : vec) {
+        v = std::uniform_real_distribution<double>(-1.0, 1.0)(gen);
+      }
+      tf.run(f).get();
+      REQUIRE(std::is_sorted(vec.begin(), vec.end()));
+    }
+  }
+}
+
 // --------------------------------------------------------
 // Testcase: Reduce
 // --------------------------------------------------------
@@ -1051,3 +1433,1275 @@ TEST_CASE("Framework" * doctest::timeout(300)) {
 }
 
 
+
+// --------------------------------------------------------
+// Testcase: FrozenFramework
+// --------------------------------------------------------
+TEST_CASE("FrozenFramework" * doctest::timeout(300)) {
+
+  // Each task checks that all its predecessors have run in this round 
+  // and none of its successors has run yet.
+  auto build = [] (tf::Framework& f, std::vector<std::atomic<size_t>>& runs, 
+                   std::atomic<bool>& ok, size_t levels, size_t width) {
+    std::vector<tf::Task> tasks;
+    std::vector<std::vector<size_t>> preds(runs.size());
+    std::mt19937 g(0);
+    for(size_t i=0; i<levels*width; ++i) {
+      if(i >= width) {
+        for(size_t k=0; k<3; ++k) {
+          preds[i].push_back((i/width-1)*width + g()%width);
+        }
+      }
+      tasks.push_back(f.emplace([&, i, p=preds[i]] () {
+        auto r = runs[i].load();
+        for(auto j : p) {
+          if(runs[j] != r + 1) ok = false;
+        }
+        runs[i]++;
+      }));
+    }
+    for(size_t i=0; i<tasks.size(); ++i) {
+      for(auto j : preds[i]) {
+        tasks[j].precede(tasks[i]);
+      }
+    }
+    return tasks;
+  };
+
+  SUBCASE("RunN") {
+    for(unsigned W=0; W<=4; ++W) {
+      std::vector<std::atomic<size_t>> runs(200);
+      std::atomic<bool> ok {true};
+      tf::Framework f;
+      build(f, runs, ok, 20, 10);
+      f.freeze();
+      tf::Taskflow tf(W);
+      tf.run_n(f, 100).get();
+      tf.run_n(f, 100);
+      tf.run_until(f, [n=100] () mutable { return n-- == 0; });
+      tf.wait_for_all();
+      REQUIRE(ok);
+      for(auto& r : runs) {
+        REQUIRE(r == 300);
+      }
+    }
+  }
+
+  SUBCASE("Refreeze") {
+    for(unsigned W=0; W<=4; ++W) {
+      std::vector<std::atomic<size_t>> runs(100);
+      std::atomic<bool> ok {true};
+      tf::Framework f;
+      auto tasks = build(f, runs, ok, 10, 10);
+      tf::Taskflow tf(W);
+      tf.run_n(f, 50).get();
+
+      // a new sink and a new edge from the sources to the sinks
+      std::atomic<size_t> count {0};
+      auto sink = f.emplace([&] () { 
+        if(runs[99] != 50 + count + 1) ok = false;
+        count++; 
+      });
+      tasks[99].precede(sink);
+      tasks[0].precede(tasks[95]);
+      tf.run_n(f, 50).get();
+
+      REQUIRE(ok);
+      REQUIRE(count == 50);
+      for(auto& r : runs) {
+        REQUIRE(r == 100);
+      }
+    }
+  }
+
+  SUBCASE("Subflow") {
+    for(unsigned W=0; W<=4; ++W) {
+      std::atomic<size_t> count {0};
+      tf::Framework f;
+      auto A = f.emplace([&](){ count ++; });
+      auto B = f.emplace([&](auto& subflow){ 
+        count ++; 
+        auto B1 = subflow.emplace([&](){ count++; });
+        auto B2 = subflow.emplace([&](){ count++; });
+        B1.precede(B2);
+      });
+      auto C = f.emplace([&](auto& subflow){ 
+        count ++; 
+        subflow.emplace([&](){ count++; });
+        subflow.detach();
+      });
+      auto D = f.emplace([&](){ count ++; });
+      A.precede(B, C);
+      B.precede(D); 
+      C.precede(D);
+      f.freeze();
+
+      tf::Taskflow tf(W);
+      tf.run_n(f, 100).get();
+      REQUIRE(count == 700);
+    }
+  }
+}
+
+// --------------------------------------------------------
+// Testcase: OverlappedFramework
+// --------------------------------------------------------
+TEST_CASE("OverlappedFramework" * doctest::timeout(300)) {
+
+  // Each task of round r checks that it has run r times, its predecessors
+  // have run round r, and the sinks have completed round r - W.
+  auto build = [] (tf::Framework& f, std::vector<std::atomic<size_t>>& runs, 
+                   std::atomic<bool>& ok, size_t levels, size_t width) {
+    std::vector<tf::Task> tasks;
+    std::vector<std::vector<size_t>> preds(runs.size());
+    std::mt19937 g(0);
+    for(size_t i=0; i<levels*width; ++i) {
+      if(i >= width) {
+        for(size_t k=0; k<3; ++k) {
+          preds[i].push_back((i/width-1)*width + g()%width);
+        }
+      }
+      tasks.push_back(f.emplace([&, i, p=preds[i], levels, width] () {
+        auto r = runs[i].load();
+        for(auto j : p) {
+          if(runs[j] < r + 1) ok = false;
+        }
+        for(size_t j=(levels-1)*width; j<levels*width; ++j) {
+          if(runs[j] + f.overlap() < r + 1) ok = false;
+        }
+        runs[i]++;
+      }));
+    }
+    for(size_t i=0; i<tasks.size(); ++i) {
+      for(auto j : preds[i]) {
+        tasks[j].precede(tasks[i]);
+      }
+    }
+  };
+
+  SUBCASE("RunN") {
+    for(unsigned W=0; W<=4; ++W) {
+      for(size_t overlap : {1, 2, 3, 8}) {
+        std::vector<std::atomic<size_t>> runs(100);
+        std::atomic<bool> ok {true};
+        tf::Framework f;
+        build(f, runs, ok, 10, 10);
+        f.overlap(overlap);
+        REQUIRE(f.overlap() == overlap);
+        tf::Taskflow tf(W);
+        tf.run_n(f, 100).get();
+        tf.run_n(f, 1);
+        tf.run_n(f, 99);
+        tf.wait_for_all();
+        REQUIRE(ok);
+        for(auto& r : runs) {
+          REQUIRE(r == 200);
+        }
+      }
+    }
+  }
+
+  SUBCASE("RunUntil") {
+    for(unsigned W=1; W<=4; ++W) {
+      for(size_t overlap : {2, 4, 16}) {
+        std::vector<std::atomic<size_t>> runs(50);
+        std::atomic<bool> ok {true};
+        tf::Framework f;
+        build(f, runs, ok, 5, 10);
+        f.overlap(overlap);
+        tf::Taskflow tf(W);
+        for(size_t N : {0, 1, 3, 40}) {
+          size_t calls = 0;
+          tf.run_until(f, [&, n=N] () mutable { ++calls; return n-- == 0; }, [&] () {
+            REQUIRE(calls == N + 1);
+          }).get();
+        }
+        REQUIRE(ok);
+        for(auto& r : runs) {
+          REQUIRE(r == 44);
+        }
+      }
+    }
+  }
+
+  // B of round r waits for A of round r+1
+  SUBCASE("Overlap") {
+    for(unsigned W=2; W<=4; ++W) {
+      std::atomic<size_t> a {0};
+      size_t b {0};
+      tf::Framework f;
+      auto A = f.emplace([&](){ a++; });
+      auto B = f.emplace([&](){ 
+        while(a < std::min(b + 2, size_t{100})) {
+          std::this_thread::yield();
+        }
+        b++;
+      });
+      A.precede(B);
+      f.overlap(2);
+
+      tf::Taskflow tf(W);
+      tf.run_n(f, 100).get();
+      REQUIRE(a == 100);
+      REQUIRE(b == 100);
+    }
+  }
+
+  SUBCASE("Subflow") {
+    for(unsigned W=1; W<=4; ++W) {
+      std::atomic<size_t> count {0};
+      tf::Framework f;
+      auto A = f.emplace([&](){ count ++; });
+      auto B = f.emplace([&](auto& subflow){ 
+        count ++; 
+        auto B1 = subflow.emplace([&](){ count++; });
+        auto B2 = subflow.emplace([&](){ count++; });
+        B1.precede(B2);
+      });
+      auto C = f.emplace([&](auto& subflow){ 
+        count ++; 
+        subflow.emplace([&](){ count++; });
+        subflow.detach();
+      });
+      auto D = f.emplace([&](){ count ++; });
+      A.precede(B, C);
+      B.precede(D); 
+      f.overlap(4);
+
+      tf::Taskflow tf(W);
+      tf.run_n(f, 100).get();
+      REQUIRE(count == 700);
+    }
+  }
+}
+
+// --------------------------------------------------------
+// Testcase: Pipeline
+// --------------------------------------------------------
+TEST_CASE("Pipeline" * doctest::timeout(300)) {
+
+  // Each pipe adds its number to the value of the token kept in the line 
+  // buffer; serial pipes check the order of tokens.
+  auto test = [] (unsigned W, size_t L, const std::vector<tf::PipeType>& types) {
+
+    const size_t N = 1000;
+    const size_t P = types.size();
+
+    std::vector<size_t> buffer(L);
+    std::vector<size_t> next(P, 0);
+    std::vector<std::atomic<size_t>> count(P);
+    std::atomic<size_t> in_flight {0};
+    std::atomic<bool> ok {true};
+    std::vector<size_t> sum(P, 0);
+
+    auto pipe = [&] (size_t p) {
+      return tf::Pipe{types[p], [&, p, P] (tf::Pipeflow& pf) {
+        if(pf.pipe() != p || pf.line() != pf.token() % L) {
+          ok = false;
+        }
+        if(p == 0) {
+          if(pf.token() == N) {
+            pf.stop();
+            return;
+          }
+          if(++in_flight > L) {
+            ok = false;
+          }
+          buffer[pf.line()] = pf.token();
+        }
+        else if(buffer[pf.line()] != pf.token() + p) {
+          ok = false;
+        }
+        if(types[p] == tf::PipeType::SERIAL) {
+          if(next[p]++ != pf.token()) {
+            ok = false;
+          }
+        }
+        count[p]++;
+        if(p + 1 < P) {
+          buffer[pf.line()]++;
+        }
+        else {
+          --in_flight;
+        }
+      }};
+    };
+
+    std::vector<tf::Pipe> pipes;
+    for(size_t p=0; p<P; ++p) {
+      pipes.push_back(pipe(p));
+    }
+    
+    tf::Taskflow tf(W);
+
+    auto run = [&] (auto&& pl) {
+      for(size_t r=1; r<=3; ++r) {
+        std::fill(next.begin(), next.end(), 0);
+        tf.run(pl, [&](){ REQUIRE(pl.num_tokens() == N); }).get();
+        REQUIRE(ok);
+        for(auto& c : count) {
+          REQUIRE(c == N * r);
+        }
+      }
+      REQUIRE(pl.num_lines() == L);
+      REQUIRE(pl.num_pipes() == P);
+    };
+    
+    switch(P) {
+      case 1: run(tf::Pipeline(L, std::move(pipes[0]))); break;
+      case 2: run(tf::Pipeline(L, std::move(pipes[0]), std::move(pipes[1]))); break;
+      case 3: run(tf::Pipeline(L, std::move(pipes[0]), std::move(pipes[1]), 
+                               std::move(pipes[2]))); break;
+      case 5: run(tf::Pipeline(L, std::move(pipes[0]), std::move(pipes[1]), 
+                               std::move(pipes[2]), std::move(pipes[3]),
+                               std::move(pipes[4]))); break;
+    }
+  };
+
+  using T = tf::PipeType;
+
+  for(unsigned W=0; W<=4; ++W) {
+    for(size_t L : {1, 2, 3, 8}) {
+      test(W, L, {T::SERIAL});
+      test(W, L, {T::SERIAL, T::SERIAL});
+      test(W, L, {T::SERIAL, T::PARALLEL});
+      test(W, L, {T::SERIAL, T::PARALLEL, T::SERIAL});
+      test(W, L, {T::SERIAL, T::PARALLEL, T::PARALLEL, T::SERIAL, T::PARALLEL});
+    }
+  }
+
+  // runs of the same pipeline queue up
+  for(unsigned W=1; W<=4; ++W) {
+    std::atomic<size_t> count {0};
+    tf::Pipeline pl(4,
+      tf::Pipe{T::SERIAL, [&](tf::Pipeflow& pf) { if(pf.token() == 100) pf.stop(); }},
+      tf::Pipe{T::PARALLEL, [&](tf::Pipeflow&) { count++; }}
+    );
+    tf::Taskflow tf(W);
+    for(size_t r=0; r<10; ++r) {
+      tf.run(pl);
+    }
+    tf.wait_for_all();
+    REQUIRE(count == 1000);
+  }
+  
+  REQUIRE_THROWS(tf::Pipeline(0, tf::Pipe{T::SERIAL, [](tf::Pipeflow&){}}));
+  REQUIRE_THROWS(tf::Pipeline(1, tf::Pipe{T::PARALLEL, [](tf::Pipeflow&){}}));
+}
+
+// --------------------------------------------------------
+// Testcase: Dataflow
+// --------------------------------------------------------
+TEST_CASE("Dataflow" * doctest::timeout(300)) {
+
+  // counts the copies of a value passed along the edges
+  static std::atomic<int> copies {0};
+
+  struct Counted {
+    int value;
+    Counted(int v) : value {v} {}
+    Counted(const Counted& rhs) : value {rhs.value} { ++copies; }
+    Counted(Counted&&) = default;
+  };
+
+  for(unsigned W=0; W<=4; ++W) {
+
+    tf::Taskflow tf(W);
+    tf::Framework f;
+    
+    int x = 0;
+    std::weak_ptr<int> observer;
+    std::vector<int> results(3);
+
+    // A -> B -> D and A -> C -> D, and a chain moving a value along 
+    auto A = f.dataflow([&] () { return x; });
+    auto B = f.dataflow([] (int a) { return a + 1; }, A);
+    auto C = f.dataflow([] (int a) { return std::to_string(a * 2); }, A);
+    auto D = f.dataflow([] (int b, std::string c) { 
+      return std::to_string(b) + "," + c; 
+    }, B, C);
+
+    auto E = f.dataflow([&] () { return Counted(x); });
+    auto F = f.dataflow([] (Counted e) { return Counted(e.value + 1); }, E);
+    auto G = f.dataflow([] (Counted&& e) { return Counted(e.value + 1); }, F);
+    
+    // a fan-out of a value released after its last consumer
+    auto H = f.dataflow([&] () { 
+      auto p = std::make_shared<int>(x); 
+      observer = p;
+      return p; 
+    });
+    for(int i=0; i<3; ++i) {
+      f.dataflow([&, i] (const std::shared_ptr<int>& p) { results[i] = *p + i; }, H);
+    }
+    
+    // a move-only value
+    auto P = f.dataflow([&] () { return std::make_unique<int>(x); });
+    auto Q = f.dataflow([] (std::unique_ptr<int> p) { return *p; }, P);
+    REQUIRE_THROWS(f.dataflow([] (std::unique_ptr<int>) {}, P));
+
+    std::string d;
+    int g = 0, q = 0;
+    f.dataflow([&] (std::string s, Counted c, int v) { 
+      d = std::move(s);
+      g = c.value;
+      q = v;
+    }, D, G, Q);
+
+    REQUIRE(A.num_consumers() == 2);
+    REQUIRE(H.num_consumers() == 3);
+    REQUIRE(P.num_consumers() == 1);
+    REQUIRE(A.num_successors() == 2);
+    REQUIRE(D.num_dependents() == 2);
+
+    for(x=1; x<=3; ++x) {
+      copies = 0;
+      tf.run(f).get();
+      REQUIRE(d == std::to_string(x+1) + "," + std::to_string(2*x));
+      REQUIRE(g == x + 2);
+      REQUIRE(q == x);
+      REQUIRE(copies == 0);
+      REQUIRE(observer.expired());
+      for(int i=0; i<3; ++i) {
+        REQUIRE(results[i] == x + i);
+      }
+    }
+
+    // each of several consumers takes a copy
+    tf::Framework f2;
+    auto S = f2.dataflow([] () { return Counted(7); });
+    std::atomic<int> sum {0};
+    for(int i=0; i<4; ++i) {
+      f2.dataflow([&] (Counted c) { sum += c.value; }, S);
+    }
+    copies = 0;
+    tf.run(f2).get();
+    REQUIRE(sum == 28);
+    REQUIRE(copies == 4);
+  }
+
+  // an exception skips the consumers of the value
+  for(unsigned W=0; W<=4; ++W) {
+    tf::Taskflow tf(W);
+    bool consumed = false;
+    auto A = tf.dataflow([] () -> int { throw std::runtime_error("A"); });
+    tf.dataflow([&] (int) { consumed = true; }, A);
+    REQUIRE_THROWS_AS(tf.dispatch().get(), std::runtime_error);
+    REQUIRE(!consumed);
+  }
+
+  // a consumer that throws still releases the value it takes
+  for(unsigned W=0; W<=4; ++W) {
+    tf::Taskflow tf(W);
+    std::weak_ptr<int> observer;
+    auto A = tf.dataflow([&] () { 
+      auto p = std::make_shared<int>(1);
+      observer = p;
+      return p;
+    });
+    tf.dataflow([] (std::shared_ptr<int>) { throw std::runtime_error("B"); }, A);
+    REQUIRE_THROWS_AS(tf.dispatch().get(), std::runtime_error);
+    REQUIRE(observer.expired());
+  }
+
+  // an overlapped framework with dataflow tasks runs one iteration at a 
+  // time, so each consumer takes the value of its own iteration
+  for(unsigned W=1; W<=4; ++W) {
+    tf::Taskflow tf(W);
+    tf::Framework f;
+    int k = 0, expected = 0, mismatches = 0;
+    auto A = f.dataflow([&] () { return k++; });
+    f.dataflow([&] (int a) { 
+      std::this_thread::sleep_for(std::chrono::microseconds(10));
+      mismatches += (a != expected++);
+    }, A);
+    f.overlap(4);
+    tf.run_n(f, 200).get();
+    REQUIRE(mismatches == 0);
+    REQUIRE(expected == 200);
+    f.freeze();
+    tf.run_n(f, 200).get();
+    REQUIRE(mismatches == 0);
+    REQUIRE(expected == 400);
+  }
+
+  // the work of a dataflow task cannot be replaced, since its consumers
+  // would take a value it no longer stores
+  {
+    tf::Taskflow tf;
+    std::string result;
+    auto A = tf.dataflow([] () { return std::string("A"); });
+    auto B = tf.dataflow([&] (std::string a) { result = a; }, A);
+    REQUIRE_THROWS_AS(A.work([] () {}), std::system_error);
+    REQUIRE_THROWS_AS(B.work([] () {}), std::system_error);
+    tf.wait_for_all();
+    REQUIRE(result == "A");
+  }
+
+  tf::Taskflow tf;
+  REQUIRE_THROWS(tf.dataflow([] (int) {}, tf::ValueTask<int>()));
+}
+
+// --------------------------------------------------------
+// Testcase: Condition
+// --------------------------------------------------------
+TEST_CASE("Condition" * doctest::timeout(300)) {
+
+  const int N = 100;
+
+  for(unsigned W=0; W<=4; ++W) {
+
+    tf::Taskflow tf(W);
+    
+    // init -> body -> cond -(0)-> body, cond -(1)-> exit
+    {
+      int counter = 0;
+      bool done = false;
+      auto init = tf.emplace([&] () { counter = 0; });
+      auto body = tf.emplace([&] () { ++counter; });
+      auto cond = tf.condition([&] () { return counter < N ? 0 : 1; });
+      auto exit = tf.emplace([&] () { done = true; });
+      init.precede(body);
+      body.precede(cond);
+      cond.precede(body, exit);
+      tf.dispatch().get();
+      REQUIRE(counter == N);
+      REQUIRE(done);
+    }
+
+    // the tasks of the branch not taken never run, including the sinks and
+    // a task joining the branch with another, and the run completes once 
+    // the branch taken is done
+    {
+      for(int b=0; b<3; ++b) {
+        std::atomic<int> ran {0};
+        std::atomic<int> joined {0};
+        auto A = tf.emplace([] () {});
+        auto C = tf.condition([=] () { return b; });
+        auto B0 = tf.emplace([&] () { ran += 1; });
+        auto B1 = tf.emplace([&] () { ran += 10; });
+        auto B2 = tf.emplace([&] () { ran += 100; });
+        auto D = tf.emplace([&] () { ++joined; });
+        A.precede(C, D);
+        C.precede(B0, B1, B2);
+        B2.precede(D);
+        tf.wait_for_all();
+        REQUIRE(ran == (b == 0 ? 1 : b == 1 ? 10 : 100));
+        REQUIRE(joined == (b == 2 ? 1 : 0));
+      }
+    }
+
+    // an index out of range releases no successor
+    {
+      bool ran = false;
+      auto C = tf.condition([] () { return 2; });
+      auto A = tf.emplace([&] () { ran = true; });
+      auto B = tf.emplace([&] () { ran = true; });
+      C.precede(A, B);
+      tf.dispatch().get();
+      auto D = tf.condition([] () { return -1; });
+      auto E = tf.emplace([&] () { ran = true; });
+      D.precede(E);
+      tf.wait_for_all();
+      REQUIRE(!ran);
+    }
+
+    // a loop in a framework starts over in each run, and a task joining 
+    // the loop with another task waits for both in each iteration
+    {
+      tf::Framework f;
+      int counter = 0;
+      std::atomic<int> joined {0};
+      auto init = f.emplace([&] () { counter = 0; });
+      auto side = f.emplace([] () {});
+      auto body = f.emplace([&] () { ++counter; });
+      auto cond = f.condition([&] () { return counter < N ? 0 : 1; });
+      auto exit = f.emplace([&] () { REQUIRE(counter == N); });
+      auto join = f.emplace([&] () { ++joined; });
+      init.precede(body);
+      body.precede(cond);
+      cond.precede(body, exit);
+      exit.precede(join);
+      side.precede(join);
+      tf.run_n(f, 10).get();
+      REQUIRE(joined == 10);
+      f.freeze();
+      tf.run_n(f, 10).get();
+      REQUIRE(joined == 20);
+      f.overlap(4);
+      tf.run_n(f, 10).get();
+      REQUIRE(joined == 30);
+    }
+
+    // a cancelled run selects no successor, which ends the loop; without 
+    // workers the loop runs inline in dispatch and is never cancelled
+    if(W > 0) {
+      std::atomic<int> counter {0};
+      auto init = tf.emplace([] () {});
+      auto body = tf.emplace([&] () { ++counter; });
+      auto cond = tf.condition([] () { return 0; });
+      init.precede(body);
+      body.precede(cond);
+      cond.precede(body);
+      auto fu = tf.dispatch();
+      while(counter < N) {
+        std::this_thread::yield();
+      }
+      fu.cancel();
+      fu.get();
+      REQUIRE(fu.is_cancelled());
+      REQUIRE(counter >= N);
+    }
+
+    // a condition task that throws ends the run
+    {
+      int counter = 0;
+      auto init = tf.emplace([] () {});
+      auto body = tf.emplace([&] () { ++counter; });
+      auto cond = tf.condition([&] () -> int { 
+        if(counter == N) throw std::runtime_error("cond");
+        return 0;
+      });
+      init.precede(body);
+      body.precede(cond);
+      cond.precede(body);
+      REQUIRE_THROWS_AS(tf.dispatch().get(), std::runtime_error);
+      REQUIRE(counter == N);
+    }
+
+    // a subflow with condition tasks fails the run and spawns nothing
+    {
+      bool ran = false;
+      tf.emplace([&] (tf::SubflowBuilder& sf) {
+        auto A = sf.condition([] () { return 0; });
+        auto B = sf.emplace([&] () { ran = true; });
+        A.precede(B);
+      });
+      REQUIRE_THROWS_AS(tf.dispatch().get(), std::system_error);
+      REQUIRE(!ran);
+    }
+  }
+
+  // a joined subflow inside a loop hands its in-flight count over to its
+  // subtasks, and the run completes each time
+  for(unsigned W=1; W<=4; ++W) {
+    tf::Taskflow tf(W);
+    for(int r=0; r<200; ++r) {
+      int counter = 0;
+      std::atomic<int> spawned {0};
+      auto init = tf.emplace([&] () { counter = 0; });
+      auto sf = tf.emplace([&] (tf::SubflowBuilder& fb) {
+        for(int i=0; i<r%4+1; ++i) {
+          fb.emplace([&] () { ++spawned; });
+        }
+        ++counter;
+      });
+      auto cond = tf.condition([&] () { return counter < 10 ? 0 : 1; });
+      auto exit = tf.emplace([] () {});
+      init.precede(sf);
+      sf.precede(cond);
+      cond.precede(sf, exit);
+      tf.wait_for_all();
+      REQUIRE(counter == 10);
+      REQUIRE(spawned == 10*(r%4+1));
+    }
+  }
+
+  // a task returning an int without being made a condition task is a 
+  // static task, which releases all its successors
+  for(unsigned W=0; W<=4; ++W) {
+    tf::Taskflow tf(W);
+    std::atomic<int> counter {0};
+    auto A = tf.emplace([&] () { return counter++; });
+    for(int i=0; i<4; ++i) {
+      A.precede(tf.emplace([&] () { ++counter; }));
+    }
+    auto B = tf.placeholder().work([&] () { return counter++; });
+    A.precede(B);
+    B.precede(tf.emplace([&] () { ++counter; }), tf.emplace([&] () { ++counter; }));
+    tf.wait_for_all();
+    REQUIRE(counter == 8);
+  }
+
+  // a condition task is drawn as a diamond with dashed edges 
+  tf::Taskflow tf;
+  auto A = tf.condition([] () { return 0; }).name("A");
+  auto B = tf.emplace([] () {}).name("B");
+  A.precede(B);
+  auto dump = tf.dump();
+  REQUIRE(dump.find("diamond") != std::string::npos);
+  REQUIRE(dump.find("dashed") != std::string::npos);
+}
+
+// --------------------------------------------------------
+// Testcase: Channel
+// --------------------------------------------------------
+TEST_CASE("Channel" * doctest::timeout(300)) {
+
+  const int N = 1000;
+
+  // producer -> consumer between a source and a sink task; items arrive in
+  // order and the producer never runs ahead by more than the capacity plus 
+  // the item it generates and the item the consumer has taken
+  for(unsigned W=0; W<=4; ++W) {
+    for(size_t C : {1, 2, 16}) {
+
+      tf::Taskflow tf(W);
+      tf::Channel<int> ch(C);
+
+      std::atomic<int> produced {0}, consumed {0};
+      std::atomic<bool> ok {true};
+      int next = 0;
+
+      auto A = tf.emplace([&](){ 
+        produced = 0; 
+        consumed = 0;
+        next = 0;
+      });
+      auto P = tf.produce(ch, [&] () -> std::optional<int> {
+        if(produced == N) {
+          return std::nullopt;
+        }
+        if(produced - consumed > static_cast<int>(C) + 1) {
+          ok = false;
+        }
+        return produced++;
+      });
+      auto Q = tf.consume(ch, [&] (int item) {
+        if(item != next++) {
+          ok = false;
+        }
+        consumed++;
+      });
+      auto B = tf.emplace([&](){
+        REQUIRE(ch.empty());
+        REQUIRE(consumed == N);
+      });
+
+      A.precede(P, Q);
+      B.gather(P, Q);
+
+      tf.wait_for_all();
+      REQUIRE(ok);
+      REQUIRE(next == N);
+      REQUIRE(ch.capacity() == C);
+    }
+  }
+
+  // producer -> transform -> transform -> consumer of move-only items in a
+  // framework run repeatedly
+  for(unsigned W=0; W<=4; ++W) {
+    for(size_t C : {1, 3, 64}) {
+
+      tf::Taskflow tf(W);
+      tf::Framework f;
+      tf::Channel<std::unique_ptr<int>> c1(C);
+      tf::Channel<long> c2(C);
+      tf::Channel<std::string> c3(C);
+
+      int i = 0;
+      std::vector<std::string> out;
+
+      f.produce(c1, [&] () -> std::optional<std::unique_ptr<int>> {
+        if(i == N) {
+          return std::nullopt;
+        }
+        return std::make_unique<int>(i++);
+      });
+      f.transform(c1, c2, [] (std::unique_ptr<int> p) { return 2L * *p; });
+      f.transform(c2, c3, [] (long v) { return std::to_string(v); });
+      f.consume(c3, [&] (std::string s) { out.push_back(std::move(s)); });
+
+      for(int r=1; r<=3; ++r) {
+        i = 0;
+        out.clear();
+        tf.run(f).get();
+        REQUIRE(out.size() == N);
+        for(int k=0; k<N; ++k) {
+          REQUIRE(out[k] == std::to_string(2*k));
+        }
+      }
+    }
+  }
+
+  // streams inside a subflow
+  for(unsigned W=0; W<=4; ++W) {
+    tf::Taskflow tf(W);
+    tf::Channel<int> ch(4);
+    int i = 0, sum = 0;
+    tf.emplace([&] (tf::SubflowBuilder& sf) {
+      sf.produce(ch, [&] () -> std::optional<int> {
+        if(i == N) return std::nullopt;
+        return i++;
+      });
+      sf.consume(ch, [&] (int item) { sum += item; });
+    });
+    tf.wait_for_all();
+    REQUIRE(sum == N*(N-1)/2);
+  }
+
+  REQUIRE_THROWS(tf::Channel<int>(0));
+}
+
+// --------------------------------------------------------
+// Testcase: Cancel
+// --------------------------------------------------------
+TEST_CASE("Cancel" * doctest::timeout(300)) {
+
+  // A task of the run holds the run until the main thread cancels it, so
+  // the tasks that have not started when the run is cancelled are known.
+  struct Gate {
+    std::atomic<bool> entered {false};
+    std::atomic<bool> released {false};
+    void hold() {
+      entered = true;
+      while(!released) std::this_thread::yield();
+    }
+    void cancel(tf::Future& fu) {
+      while(!entered) std::this_thread::yield();
+      REQUIRE(fu.cancel());
+      REQUIRE(fu.is_cancelled());
+      released = true;
+      fu.get();
+      entered = false;
+      released = false;
+    }
+  };
+
+  // a chain dispatched from the taskflow stops after its first task
+  for(unsigned W=1; W<=4; ++W) {
+    tf::Taskflow tf(W);
+    Gate gate;
+    std::atomic<int> count {0};
+    std::vector<tf::Task> chain;
+    for(int i=0; i<100; ++i) {
+      chain.push_back(tf.emplace([&, i] () {
+        ++count;
+        if(i == 0) gate.hold();
+      }));
+    }
+    tf.linearize(chain);
+    auto fu = tf.dispatch();
+    gate.cancel(fu);
+    REQUIRE(count == 1);
+    REQUIRE(!fu.cancel());
+  }
+
+  // a repeated framework run stops within the iteration being run, and 
+  // the framework runs to completion afterwards
+  for(unsigned W=1; W<=4; ++W) {
+    for(size_t overlap : {1, 3}) {
+
+      tf::Taskflow tf(W);
+      tf::Framework f;
+      Gate gate;
+      std::atomic<int> a {0}, b {0}, s {0};
+
+      auto A = f.emplace([&] () { 
+        if(++a == 1) gate.hold(); 
+      });
+      auto B = f.emplace([&] (tf::SubflowBuilder& sf) {
+        ++b;
+        sf.emplace([&] () { ++s; });
+      });
+      A.precede(B);
+      f.overlap(overlap);
+
+      auto fu = tf.run_n(f, 1000);
+      gate.cancel(fu);
+      REQUIRE(b + 1 == a);
+      REQUIRE(s == b);
+      REQUIRE(a <= static_cast<int>(overlap));
+
+      a = 0; b = 0; s = 0;
+      gate.released = true;
+      tf.run_n(f, 10).get();
+      REQUIRE(a == 10);
+      REQUIRE(b == 10);
+      REQUIRE(s == 10);
+    }
+  }
+
+  // a pipeline stops generating tokens and runs again from the start
+  for(unsigned W=1; W<=4; ++W) {
+    tf::Taskflow tf(W);
+    Gate gate;
+    std::atomic<size_t> last {0};
+    tf::Pipeline pl(4,
+      tf::Pipe{tf::PipeType::SERIAL, [&](tf::Pipeflow& pf) {
+        if(pf.token() == 10 && !gate.released) gate.hold();
+        if(pf.token() == 100) pf.stop();
+      }},
+      tf::Pipe{tf::PipeType::SERIAL, [&](tf::Pipeflow& pf) {
+        last = pf.token();
+      }}
+    );
+    auto fu = tf.run(pl);
+    gate.cancel(fu);
+    REQUIRE(pl.num_tokens() == 11);
+    REQUIRE(last < 10);
+    gate.released = true;
+    tf.run(pl).get();
+    REQUIRE(pl.num_tokens() == 100);
+    REQUIRE(last == 99);
+  }
+
+  // an endless stream ends and leaves the channel ready for the next run
+  for(unsigned W=1; W<=4; ++W) {
+    tf::Taskflow tf(W);
+    tf::Framework f;
+    tf::Channel<int> c1(4), c2(2);
+    Gate gate;
+    bool endless = true;
+    int i = 0, n = 0;
+    f.produce(c1, [&] () -> std::optional<int> {
+      if(!endless && i == 100) return std::nullopt;
+      return i++;
+    });
+    f.transform(c1, c2, [] (int v) { return v; });
+    f.consume(c2, [&] (int) { 
+      if(++n == 50 && endless) gate.hold(); 
+    });
+
+    auto fu = tf.run(f);
+    gate.cancel(fu);
+    REQUIRE(n == 50);
+    REQUIRE(c1.empty());
+    REQUIRE(c2.empty());
+
+    endless = false;
+    i = 0; n = 0;
+    tf.run(f).get();
+    REQUIRE(n == 100);
+  }
+
+  // a run that completed or has no work cannot be cancelled
+  tf::Taskflow tf(2);
+  tf::Framework f;
+  f.emplace([](){});
+  auto fu = tf.run(f);
+  fu.get();
+  REQUIRE(!fu.cancel());
+  REQUIRE(!fu.is_cancelled());
+  REQUIRE(!tf.dispatch().cancel());
+  REQUIRE(!tf::Future().cancel());
+}
+
+// --------------------------------------------------------
+// Testcase: Exception
+// --------------------------------------------------------
+TEST_CASE("Exception" * doctest::timeout(300)) {
+
+  // the first exception reaches the future and the successors are skipped
+  for(unsigned W=0; W<=4; ++W) {
+    tf::Taskflow tf(W);
+    std::atomic<int> count {0};
+    auto A = tf.emplace([&] () { ++count; });
+    auto B = tf.emplace([&] () { throw std::runtime_error("B"); });
+    auto C = tf.emplace([&] () { ++count; });
+    auto D = tf.emplace([&] () { ++count; });
+    A.precede(B);
+    B.precede(C);
+    C.precede(D);
+    auto fu = tf.dispatch();
+    REQUIRE_THROWS_AS(fu.get(), std::runtime_error);
+    REQUIRE(fu.is_cancelled());
+    REQUIRE(count == 1);
+    REQUIRE_THROWS_AS(tf.wait_for_topologies(), std::runtime_error);
+
+    // of many throwing tasks, one exception is kept
+    for(int i=0; i<100; ++i) {
+      tf.emplace([i] () { throw std::logic_error(std::to_string(i)); });
+    }
+    REQUIRE_THROWS_AS(tf.wait_for_all(), std::logic_error);
+    REQUIRE(tf.num_topologies() == 0);
+
+    // the taskflow runs new graphs as usual
+    tf.emplace([&] () { ++count; });
+    tf.wait_for_all();
+    REQUIRE(count == 2);
+  }
+
+  // a repeated framework run stops at the iteration that throws and the 
+  // framework runs again afterwards
+  for(unsigned W=0; W<=4; ++W) {
+    tf::Taskflow tf(W);
+    tf::Framework f;
+    int a = 0, b = 0, s = 0;
+    auto A = f.emplace([&] () { 
+      if(++a == 3) throw std::runtime_error("A");
+    });
+    auto B = f.emplace([&] (tf::SubflowBuilder& sf) {
+      ++b;
+      sf.emplace([&] () { ++s; });
+    });
+    A.precede(B);
+    REQUIRE_THROWS_AS(tf.run_n(f, 100).get(), std::runtime_error);
+    REQUIRE(a == 3);
+    REQUIRE(b == 2);
+    REQUIRE(s == 2);
+
+    a = 10; b = 0; s = 0;
+    tf.run_n(f, 5).get();
+    REQUIRE(a == 15);
+    REQUIRE(b == 5);
+    REQUIRE(s == 5);
+  }
+
+  // an exception in a subflow
+  for(unsigned W=0; W<=4; ++W) {
+    tf::Taskflow tf(W);
+    int count = 0;
+    auto A = tf.emplace([&] (tf::SubflowBuilder& sf) {
+      auto B = sf.emplace([] () { throw std::runtime_error("B"); });
+      auto C = sf.emplace([&] () { ++count; });
+      B.precede(C);
+    });
+    auto D = tf.emplace([&] () { ++count; });
+    A.precede(D);
+    REQUIRE_THROWS_AS(tf.dispatch().get(), std::runtime_error);
+    REQUIRE(count == 0);
+  }
+
+  // a pipe that throws stops the pipeline
+  for(unsigned W=0; W<=4; ++W) {
+    tf::Taskflow tf(W);
+    tf::Pipeline pl(4,
+      tf::Pipe{tf::PipeType::SERIAL, [&](tf::Pipeflow& pf) {
+        if(pf.token() == 100) pf.stop();
+      }},
+      tf::Pipe{tf::PipeType::PARALLEL, [&](tf::Pipeflow& pf) {
+        if(pf.token() == 10) throw std::runtime_error("pipe");
+      }}
+    );
+    REQUIRE_THROWS_AS(tf.run(pl).get(), std::runtime_error);
+    REQUIRE(pl.num_tokens() < 100);
+  }
+
+  // a consumer that throws ends an endless stream
+  for(unsigned W=0; W<=4; ++W) {
+    tf::Taskflow tf(W);
+    tf::Framework f;
+    tf::Channel<int> c1(4), c2(2);
+    bool endless = true;
+    int i = 0, n = 0;
+    f.produce(c1, [&] () -> std::optional<int> {
+      if(!endless && i == 100) return std::nullopt;
+      return i++;
+    });
+    f.transform(c1, c2, [] (int v) { return v; });
+    f.consume(c2, [&] (int) { 
+      if(++n == 50 && endless) throw std::runtime_error("consume");
+    });
+
+    REQUIRE_THROWS_AS(tf.run(f).get(), std::runtime_error);
+    REQUIRE(n == 50);
+    REQUIRE(c1.empty());
+    REQUIRE(c2.empty());
+
+    endless = false;
+    i = 0; n = 0;
+    tf.run(f).get();
+    REQUIRE(n == 100);
+  }
+}
+
+// --------------------------------------------------------
+// Testcase: Priority
+// --------------------------------------------------------
+TEST_CASE("Priority" * doctest::timeout(300)) {
+
+  const std::vector<tf::TaskPriority> levels {
+    tf::TaskPriority::LOW, tf::TaskPriority::NORMAL, tf::TaskPriority::HIGH,
+    tf::TaskPriority::NORMAL, tf::TaskPriority::LOW, tf::TaskPriority::HIGH
+  };
+
+  SUBCASE("Ordering") {
+
+    tf::Taskflow tf(1);
+
+    std::vector<tf::TaskPriority> order;
+
+    auto A = tf.emplace([](){});
+    REQUIRE(A.priority() == tf::TaskPriority::NORMAL);
+
+    for(auto l : levels) {
+      auto B = tf.emplace([&, l] () { order.push_back(l); }).priority(l);
+      REQUIRE(B.priority() == l);
+      A.precede(B);
+    }
+
+    tf.wait_for_all();
+
+    REQUIRE(order.size() == levels.size());
+    REQUIRE(std::is_sorted(order.begin(), order.end()));
+  }
+
+  SUBCASE("Mixed") {
+    for(unsigned W=0; W<=4; ++W) {
+      tf::Taskflow tf(W);
+      std::atomic<int> counter {0};
+      auto S = tf.emplace([](){});
+      auto T = tf.emplace([](){});
+      for(int i=0; i<1000; ++i) {
+        auto B = tf.emplace([&] () { counter++; }).priority(levels[i % levels.size()]);
+        S.precede(B);
+        B.precede(T);
+      }
+      tf.wait_for_all();
+      REQUIRE(counter == 1000);
+    }
+  }
+}
+
+// --------------------------------------------------------
+// Testcase: HelpingWait
+// --------------------------------------------------------
+TEST_CASE("HelpingWait" * doctest::timeout(300)) {
+
+  SUBCASE("Graph") {
+    for(unsigned W=0; W<=4; ++W) {
+      tf::Taskflow tf(W);
+      tf.helping_wait(true);
+      REQUIRE(tf.helping_wait());
+      std::atomic<int> counter {0};
+      for(int i=0; i<100; ++i) {
+        tf.emplace([&] (auto& subflow) {
+          for(int j=0; j<10; ++j) {
+            subflow.emplace([&] () { counter++; });
+          }
+        });
+      }
+      tf.wait_for_all();
+      REQUIRE(counter == 1000);
+    }
+  }
+
+  // the only worker blocks in one task until the waiting thread runs the other
+  SUBCASE("Participation") {
+    tf::Taskflow tf(1);
+    tf.helping_wait(true);
+    for(int i=0; i<10; ++i) {
+      std::atomic<bool> flag {false};
+      tf.emplace([&] () { while(!flag) std::this_thread::yield(); flag = false; });
+      tf.emplace([&] () { while(flag) std::this_thread::yield(); flag = true; });
+      tf.wait_for_all();
+    }
+  }
+
+  SUBCASE("Future") {
+    for(unsigned W=0; W<=4; ++W) {
+      tf::Taskflow tf(W);
+      tf.helping_wait(true);
+      
+      std::atomic<int> counter {0};
+      tf.emplace([&] () { counter++; });
+      tf.wait(tf.dispatch());
+      REQUIRE(counter == 1);
+
+      tf::Framework f;
+      auto A = f.emplace([&] () { counter++; });
+      auto B = f.emplace([&] () { counter++; });
+      A.precede(B);
+      tf.wait(tf.run_n(f, 10));
+      REQUIRE(counter == 21);
+      tf.wait(tf.run_n(f, 0));
+      REQUIRE(counter == 21);
+      tf.wait_for_topologies();
+    }
+  }
+  
+  // a worker waiting for another taskflow on the same executor
+  SUBCASE("Nested") {
+    for(unsigned W=1; W<=4; ++W) {
+      tf::Taskflow tf1(W);
+      std::atomic<int> counter {0};
+      for(unsigned i=0; i<W; ++i) {
+        tf1.emplace([&] () {
+          tf::Taskflow tf2(tf1.share_executor());
+          tf2.helping_wait(true);
+          for(int j=0; j<100; ++j) {
+            tf2.emplace([&] () { counter++; });
+          }
+          tf2.wait_for_all();
+        });
+      }
+      tf1.wait_for_all();
+      REQUIRE(counter == 100 * W);
+    }
+  }
+}
+
+// --------------------------------------------------------
+// Testcase: MoveOnlyTask
+// --------------------------------------------------------
+TEST_CASE("MoveOnlyTask" * doctest::timeout(300)) {
+  for(unsigned W=0; W<=4; ++W) {
+    tf::Taskflow tf(W);
+    std::atomic<int> sum {0};
+    for(int i=0; i<100; ++i) {
+      auto A = tf.emplace([&sum, p=std::make_unique<int>(i)] () { sum += *p; });
+      auto B = tf.emplace([&sum, p=std::make_unique<int>(i)] (auto& subflow) { 
+        subflow.emplace([&sum, q=std::make_unique<int>(*p)] () { sum += *q; });
+      });
+      auto C = tf.placeholder();
+      C.work([&sum, p=std::make_unique<int>(1)] () { sum += *p; });
+      A.precede(B);
+      B.precede(C);
+    }
+    tf.wait_for_all();
+    REQUIRE(sum == 2 * 4950 + 100);
+  }
+}
+
+// --------------------------------------------------------
+// Testcase: Graph
+// --------------------------------------------------------
+TEST_CASE("Graph" * doctest::timeout(300)) {
+
+  SUBCASE("Arena") {
+    for(size_t N : {0, 1, 7, 8, 9, 100, 5000}) {
+      tf::Graph g;
+      std::vector<tf::Node*> nodes;
+      for(size_t i=0; i<N; ++i) {
+        nodes.push_back(&g.emplace_back());
+        REQUIRE(&g.back() == nodes.back());
+      }
+      REQUIRE(g.size() == N);
+      REQUIRE(g.empty() == (N == 0));
+      REQUIRE(std::distance(g.begin(), g.end()) == N);
+      size_t i = 0;
+      for(auto& n : g) {
+        REQUIRE(&n == nodes[i++]);
+      }
+      g.clear();
+      REQUIRE(g.empty());
+      REQUIRE(g.begin() == g.end());
+    }
+  }
+
+  SUBCASE("Splice") {
+    for(size_t N : {0, 3, 100}) {
+      for(size_t M : {0, 5, 1000}) {
+        tf::Graph g1, g2;
+        std::vector<tf::Node*> nodes;
+        for(size_t i=0; i<N; ++i) nodes.push_back(&g1.emplace_back());
+        for(size_t i=0; i<M; ++i) nodes.push_back(&g2.emplace_back());
+        g1.splice(g2);
+        REQUIRE(g2.empty());
+        REQUIRE(g1.size() == N + M);
+        nodes.push_back(&g1.emplace_back());
+        REQUIRE(&g1.back() == nodes.back());
+        REQUIRE(std::distance(g1.begin(), g1.end()) == N + M + 1);
+        std::set<tf::Node*> set(nodes.begin(), nodes.end());
+        for(auto& n : g1) {
+          REQUIRE(set.erase(&n) == 1);
+        }
+        REQUIRE(set.empty());
+        tf::Graph g3 {std::move(g1)};
+        REQUIRE(g1.empty());
+        REQUIRE(g3.size() == N + M + 1);
+      }
+    }
+  }
+}
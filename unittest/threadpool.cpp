@@ -245,6 +245,268 @@ TEST_CASE("WSQ.4Thieves" * doctest::timeout(300)) {
   wsq_test_n_thieves(4);
 }
 
+// Procedure: wsq_test_reclaim
+void wsq_test_reclaim(int N) {
+
+  tf::WorkStealingQueue<std::string> queue(2);
+
+  // without thieves, retired arrays are reclaimed right away
+  for(int i=0; i<(1<<16); ++i) {
+    queue.push(std::to_string(i));
+    REQUIRE(queue.num_retired() == 0);
+  }
+  REQUIRE(queue.capacity() == (1<<16));
+  REQUIRE(!queue.shrink());
+
+  while(queue.pop());
+
+  REQUIRE(queue.shrink());
+  REQUIRE(queue.capacity() == 2);
+  REQUIRE(!queue.shrink());
+  
+  // bursts with concurrent thieves and shrinks
+  const int B = 1<<14, R = 8;
+
+  std::atomic<int> num_consumed {0};
+  std::vector<std::set<std::string>> csets(N);
+  std::set<std::string> pset;
+  std::vector<std::thread> consumers;
+
+  for(int n=0; n<N; n++) {
+    consumers.emplace_back([&, n] () {
+      while(num_consumed != B*R) {
+        if(auto item = queue.steal(); item) {
+          csets[n].insert(*item);
+          num_consumed++;
+        }
+      }
+    });
+  }
+
+  for(int r=0; r<R; ++r) {
+    for(int i=0; i<B; ++i) {
+      queue.push(std::to_string(r*B + i));
+      if(::rand() % 4 == 0) {
+        if(auto item = queue.pop(); item) {
+          pset.insert(*item);
+          num_consumed++;
+        }
+      }
+    }
+    while(auto item = queue.pop()) {
+      pset.insert(*item);
+      num_consumed++;
+    }
+    queue.shrink();
+  }
+
+  for(auto& c : consumers) {
+    c.join();
+  }
+
+  REQUIRE(queue.empty());
+
+  for(const auto& cset : csets) {
+    pset.insert(cset.begin(), cset.end());
+  }
+
+  REQUIRE(pset.size() == B*R);
+
+  queue.shrink();
+  REQUIRE(queue.num_retired() == 0);
+  REQUIRE(queue.capacity() == 2);
+}
+
+// Procedure: wsq_test_steal_batch
+void wsq_test_steal_batch(int N) {
+
+  tf::WorkStealingQueue<int> queue;
+  tf::WorkStealingQueue<int> dst;
+
+  REQUIRE(!queue.steal_batch(dst, 8));
+
+  for(int i=0; i<10; ++i) {
+    queue.push(i);
+  }
+
+  // takes half of the items in FIFO order
+  auto item = queue.steal_batch(dst, 100);
+  REQUIRE((item && *item == 0));
+  REQUIRE(queue.size() == 5);
+  REQUIRE(dst.size() == 4);
+  
+  // takes at most max items
+  REQUIRE(*queue.steal_batch(dst, 1) == 5);
+  REQUIRE(queue.size() == 4);
+  REQUIRE(dst.size() == 4);
+  
+  REQUIRE(*queue.steal_batch(dst, 2) == 6);
+  REQUIRE(queue.size() == 2);
+  REQUIRE(dst.size() == 5);
+
+  // a single item is taken as a whole
+  REQUIRE(*queue.steal_batch(dst, 8) == 8);
+  REQUIRE(*queue.steal_batch(dst, 8) == 9);
+  REQUIRE(queue.empty());
+  
+  // concurrent thieves move items into their own queues
+  const int P = 1<<18;
+
+  std::atomic<int> num_consumed {0};
+  std::vector<std::vector<int>> cvecs(N);
+  std::vector<int> pvec;
+  std::vector<std::thread> consumers;
+
+  for(int n=0; n<N; n++) {
+    consumers.emplace_back([&, n] () {
+      tf::WorkStealingQueue<int> mine;
+      while(num_consumed != P) {
+        auto item = mine.pop();
+        if(!item) {
+          item = queue.steal_batch(mine, ::rand() % 64 + 1);
+        }
+        if(item) {
+          cvecs[n].push_back(*item);
+          num_consumed++;
+        }
+      }
+    });
+  }
+
+  for(int p=0; p<P; ++p) {
+    queue.push(p);
+    if(::rand() % 4 == 0) {
+      if(auto item = queue.pop(); item) {
+        pvec.push_back(*item);
+        num_consumed++;
+      }
+    }
+  }
+
+  while(auto item = queue.pop()) {
+    pvec.push_back(*item);
+    num_consumed++;
+  }
+
+  for(auto& c : consumers) {
+    c.join();
+  }
+
+  for(const auto& cvec : cvecs) {
+    pvec.insert(pvec.end(), cvec.begin(), cvec.end());
+  }
+
+  std::sort(pvec.begin(), pvec.end());
+
+  REQUIRE(pvec.size() == P);
+
+  for(int p=0; p<P; ++p) {
+    REQUIRE(pvec[p] == p);
+  }
+}
+
+// ----------------------------------------------------------------------------
+// Testcase: WSQTest.StealBatch
+// ----------------------------------------------------------------------------
+TEST_CASE("WSQ.StealBatch" * doctest::timeout(300)) {
+  for(int N=0; N<=4; ++N) {
+    wsq_test_steal_batch(N);
+  }
+}
+
+// Procedure: mpmc_test
+void mpmc_test(int P, int C) {
+
+  tf::MPMCQueue<int> queue(2);
+  
+  REQUIRE(queue.capacity() == 2);
+  REQUIRE(queue.empty());
+  REQUIRE(!queue.pop());
+  REQUIRE(queue.try_push(1));
+  REQUIRE(queue.try_push(2));
+  REQUIRE(!queue.try_push(3));
+  REQUIRE(queue.size() == 2);
+  REQUIRE(*queue.pop() == 1);
+  REQUIRE(queue.try_push(3));
+  REQUIRE(*queue.pop() == 2);
+  REQUIRE(*queue.pop() == 3);
+  REQUIRE(queue.empty());
+
+  // producers block on a small queue while consumers drain it
+  const int N = 1<<14;
+
+  tf::MPMCQueue<int> mpmc(64);
+
+  std::atomic<int> num_consumed {0};
+  std::vector<std::vector<int>> cvecs(C);
+  std::vector<std::thread> threads;
+  
+  for(int c=0; c<C; ++c) {
+    threads.emplace_back([&, c] () {
+      while(num_consumed != N*P) {
+        if(auto item = mpmc.pop(); item) {
+          cvecs[c].push_back(*item);
+          num_consumed++;
+        }
+        else {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+
+  for(int p=0; p<P; ++p) {
+    threads.emplace_back([&, p] () {
+      for(int i=0; i<N; ++i) {
+        mpmc.push(p*N + i);
+      }
+    });
+  }
+
+  for(auto& t : threads) {
+    t.join();
+  }
+
+  REQUIRE(mpmc.empty());
+
+  std::vector<int> all;
+  for(const auto& cvec : cvecs) {
+    // items of each producer are consumed in order by each consumer
+    std::vector<int> last(P, -1);
+    for(auto k : cvec) {
+      REQUIRE(k > last[k/N]);
+      last[k/N] = k;
+    }
+    all.insert(all.end(), cvec.begin(), cvec.end());
+  }
+
+  std::sort(all.begin(), all.end());
+  REQUIRE(all.size() == N*P);
+  for(int i=0; i<N*P; ++i) {
+    REQUIRE(all[i] == i);
+  }
+}
+
+// ----------------------------------------------------------------------------
+// Testcase: MPMCQueue
+// ----------------------------------------------------------------------------
+TEST_CASE("MPMCQueue" * doctest::timeout(300)) {
+  for(int P=1; P<=3; ++P) {
+    for(int C=1; C<=3; ++C) {
+      mpmc_test(P, C);
+    }
+  }
+}
+
+// ----------------------------------------------------------------------------
+// Testcase: WSQTest.Reclaim
+// ----------------------------------------------------------------------------
+TEST_CASE("WSQ.Reclaim" * doctest::timeout(300)) {
+  for(int N=0; N<=4; ++N) {
+    wsq_test_reclaim(N);
+  }
+}
+
 
 // ============================================================================
 // Threadpool tests
@@ -472,3 +734,513 @@ TEST_CASE("WorkStealingThreadpool" * doctest::timeout(300)) {
 
 
 
+
+// ----------------------------------------------------------------------------
+// Testcase: CpuTopology
+// ----------------------------------------------------------------------------
+TEST_CASE("CpuTopology" * doctest::timeout(300)) {
+
+  using cpus = std::vector<unsigned>;
+  
+  REQUIRE(tf::CpuTopology::parse_cpulist("") == cpus{});
+  REQUIRE(tf::CpuTopology::parse_cpulist("3") == cpus{3});
+  REQUIRE(tf::CpuTopology::parse_cpulist("0-3") == cpus{0, 1, 2, 3});
+  REQUIRE(tf::CpuTopology::parse_cpulist("0-1,8,10-11\n") == cpus{0, 1, 8, 10, 11});
+
+  tf::CpuTopology topology({{0, 1, 2, 3}, {}, {4, 5, 6, 7}});
+  REQUIRE(topology.num_domains() == 2);
+  REQUIRE(topology.num_cpus() == 8);
+  REQUIRE(topology.domain_of(1) == 0);
+  REQUIRE(topology.domain_of(6) == 1);
+  REQUIRE(topology.cpu_at(5) == 5);
+  REQUIRE(topology.cpu_at(9) == 1);
+
+  REQUIRE(tf::CpuTopology::system().num_domains() >= 1);
+  REQUIRE(tf::CpuTopology::system().num_cpus() >= 1);
+
+#if defined(__linux__)
+  // the detected processors lie in the affinity mask of the process
+  cpu_set_t mask;
+  REQUIRE(sched_getaffinity(0, sizeof(mask), &mask) == 0);
+  for(size_t i=0; i<tf::CpuTopology::system().num_cpus(); ++i) {
+    REQUIRE(CPU_ISSET(tf::CpuTopology::system().cpu_at(i), &mask));
+  }
+#endif
+}
+
+// ----------------------------------------------------------------------------
+// Testcase: HierarchicalStealing
+// ----------------------------------------------------------------------------
+TEST_CASE("HierarchicalStealing" * doctest::timeout(300)) {
+
+  tf::CpuTopology topology({{0}, {1}});
+
+  for(unsigned rounds : {0u, 4u, 1024u}) {
+    for(unsigned W=0; W<=4; ++W) {
+
+      tf::WorkStealingThreadpool<std::function<void()>> tp(W, topology);
+      tp.cross_domain_rounds(rounds);
+
+      REQUIRE(tp.num_domains() == (W < 2 ? 1 : 2));
+      REQUIRE(tp.cross_domain_rounds() == rounds);
+
+      test_dynamic_tasking(tp);
+      test_external_threads(tp);
+
+      REQUIRE(tp.num_cross_domain_steals() <= tp.num_steals());
+    }
+  }
+
+#if defined(__linux__)
+  // grouping workers into domains does not pin them
+  cpu_set_t mask;
+  REQUIRE(sched_getaffinity(0, sizeof(mask), &mask) == 0);
+  for(unsigned W=1; W<=4; ++W) {
+    tf::WorkStealingThreadpool<std::function<void()>> tp(W, topology);
+    std::vector<std::promise<bool>> promises(W);
+    for(auto& p : promises) {
+      tp.emplace([&] () {
+        cpu_set_t worker;
+        p.set_value(
+          sched_getaffinity(0, sizeof(worker), &worker) == 0 && CPU_EQUAL(&mask, &worker)
+        );
+      });
+    }
+    for(auto& p : promises) {
+      REQUIRE(p.get_future().get());
+    }
+  }
+#endif
+}
+
+// ----------------------------------------------------------------------------
+// Testcase: BatchStealing
+// ----------------------------------------------------------------------------
+TEST_CASE("BatchStealing" * doctest::timeout(300)) {
+
+  for(size_t max : {0u, 1u, 2u, 32u, 1024u}) {
+    for(unsigned W=0; W<=4; ++W) {
+
+      tf::WorkStealingThreadpool<std::function<void()>> tp(W);
+      tp.max_steal_batch(max);
+
+      REQUIRE(tp.max_steal_batch() == std::max(size_t{1}, max));
+
+      test_dynamic_tasking(tp);
+      test_external_threads(tp);
+      test_batch_insertion(tp);
+    }
+  }
+
+  // a single worker that steals one closure at a time from the centralized
+  // queue runs the closures of each producer in the order they were pushed
+  {
+    constexpr size_t P = 4;
+    constexpr size_t M = 10000;
+
+    tf::WorkStealingThreadpool<std::function<void()>> tp(1);
+    tp.max_steal_batch(1);
+
+    std::array<size_t, P> next {};
+    std::atomic<size_t> mismatches {0};
+    std::atomic<size_t> count {0};
+
+    std::vector<std::thread> producers;
+    for(size_t p=0; p<P; ++p) {
+      producers.emplace_back([&, p] () {
+        for(size_t i=0; i<M; ++i) {
+          tp.emplace([&, p, i] () {
+            if(next[p]++ != i) {
+              mismatches.fetch_add(1, std::memory_order_relaxed);
+            }
+            count.fetch_add(1, std::memory_order_release);
+          });
+        }
+      });
+    }
+
+    for(auto& t : producers) {
+      t.join();
+    }
+
+    while(count.load(std::memory_order_acquire) != P*M) {
+      std::this_thread::yield();
+    }
+
+    REQUIRE(mismatches == 0);
+  }
+}
+
+// ----------------------------------------------------------------------------
+// Testcase: CpuAffinity
+// ----------------------------------------------------------------------------
+template <typename T>
+void test_affinity(const tf::CpuAffinity& affinity) {
+  for(unsigned W=0; W<=4; ++W) {
+    T tp(W, affinity);
+    test_dynamic_tasking(tp);
+    test_external_threads(tp);
+    test_batch_insertion(tp);
+  }
+}
+
+TEST_CASE("CpuAffinity" * doctest::timeout(300)) {
+  
+  using cpus = std::vector<unsigned>;
+  using cpusets = std::vector<cpus>;
+
+  tf::CpuTopology topology({{0, 1}, {2, 3}});
+
+  SUBCASE("Mapping") {
+    REQUIRE(tf::CpuAffinity().cpusets(3) == cpusets{{}, {}, {}});
+    REQUIRE(tf::CpuAffinity::numa(topology).cpusets(3) == cpusets{{0, 1}, {0, 1}, {2, 3}});
+    REQUIRE(tf::CpuAffinity::numa(tf::CpuTopology({{0, 1}})).cpusets(2) == cpusets{{}, {}});
+    REQUIRE(tf::CpuAffinity::compact(topology).cpusets(5) == cpusets{{0}, {1}, {2}, {3}, {0}});
+    REQUIRE(tf::CpuAffinity::scatter(topology).cpusets(5) == cpusets{{0}, {2}, {1}, {3}, {0}});
+    REQUIRE(tf::CpuAffinity::list(cpus{3, 1}).cpusets(3) == cpusets{{3}, {1}, {3}});
+    REQUIRE(tf::CpuAffinity::list(cpusets{{0, 1}}).cpusets(2) == cpusets{{0, 1}, {0, 1}});
+  }
+
+  SUBCASE("Exclusion") {
+    auto affinity = tf::CpuAffinity::compact(topology).exclude({0, 3});
+    REQUIRE(affinity.topology().num_cpus() == 2);
+    REQUIRE(affinity.cpusets(3) == cpusets{{1}, {2}, {1}});
+    REQUIRE(tf::CpuAffinity::list(cpusets{{0, 1}}).exclude({1}).cpusets(1) == cpusets{{0}});
+    
+    // excluding everything keeps the topology untouched
+    REQUIRE(tf::CpuAffinity::compact(topology).exclude({0, 1, 2, 3}).topology().num_cpus() == 4);
+
+    tf::CpuAffinity::compact().exclude_isolated();
+  }
+
+  SUBCASE("WorkerDomains") {
+    tf::WorkStealingThreadpool<std::function<void()>> tp1(4, tf::CpuAffinity::scatter(topology));
+    REQUIRE(tp1.num_domains() == 2);
+    tf::WorkStealingThreadpool<std::function<void()>> tp2(4, tf::CpuAffinity::list(cpus{2}));
+    REQUIRE(tp2.num_domains() == 1);
+    tf::WorkStealingThreadpool<std::function<void()>> tp3(4, tf::CpuAffinity());
+    REQUIRE(tp3.num_domains() == 1);
+  }
+
+  for(auto affinity : {
+    tf::CpuAffinity(), 
+    tf::CpuAffinity::numa(), 
+    tf::CpuAffinity::compact(), 
+    tf::CpuAffinity::scatter(topology),
+    tf::CpuAffinity::list(cpus{0})
+  }) {
+    test_affinity<tf::SimpleThreadpool<std::function<void()>>>(affinity);
+    test_affinity<tf::ProactiveThreadpool<std::function<void()>>>(affinity);
+    test_affinity<tf::SpeculativeThreadpool<std::function<void()>>>(affinity);
+    test_affinity<tf::WorkStealingThreadpool<std::function<void()>>>(affinity);
+  }
+}
+
+// ----------------------------------------------------------------------------
+// Testcase: TaskPriority
+// ----------------------------------------------------------------------------
+struct PriorityClosure {
+  
+  PriorityClosure() = default;
+  
+  template <typename C>
+  PriorityClosure(tf::TaskPriority p, C&& c) : level {p}, work {std::forward<C>(c)} {
+  }
+
+  tf::TaskPriority priority() const { return level; }
+
+  void operator ()() { work(); }
+
+  tf::TaskPriority level {tf::TaskPriority::NORMAL};
+  std::function<void()> work;
+};
+
+TEST_CASE("TaskPriority" * doctest::timeout(300)) {
+
+  using namespace std::literals::chrono_literals;
+
+  static_assert(tf::has_priority_v<PriorityClosure>);
+  static_assert(!tf::has_priority_v<std::function<void()>>);
+
+  const std::vector<tf::TaskPriority> levels {
+    tf::TaskPriority::LOW, tf::TaskPriority::NORMAL, tf::TaskPriority::HIGH,
+    tf::TaskPriority::LOW, tf::TaskPriority::HIGH,   tf::TaskPriority::NORMAL,
+    tf::TaskPriority::MAX, tf::TaskPriority::HIGH
+  };
+
+  // levels beyond the least urgent one are clamped
+  auto is_ordered = [] (const std::vector<tf::TaskPriority>& order) {
+    return std::is_sorted(order.begin(), order.end(), [] (auto a, auto b) {
+      return std::min(a, tf::TaskPriority::LOW) < std::min(b, tf::TaskPriority::LOW);
+    });
+  };
+
+  // closures inserted by an external thread while the only worker is busy
+  SUBCASE("Centralized") {
+
+    tf::WorkStealingThreadpool<PriorityClosure> tp(1);
+
+    std::mutex mutex;
+    std::vector<tf::TaskPriority> order;
+    std::atomic<bool> started {false}, release {false};
+    std::atomic<size_t> counter {0};
+
+    tp.emplace(tf::TaskPriority::LOW, [&] () {
+      started = true;
+      while(!release) std::this_thread::sleep_for(1ms);
+    });
+
+    while(!started) std::this_thread::yield();
+
+    std::vector<PriorityClosure> closures;
+    for(auto l : levels) {
+      closures.emplace_back(l, [&, l] () {
+        std::scoped_lock lock(mutex);
+        order.push_back(l);
+        counter++;
+      });
+    }
+    tp.batch(closures);
+
+    release = true;
+    while(counter != levels.size()) std::this_thread::yield();
+
+    REQUIRE(is_ordered(order));
+  }
+
+  // closures inserted by the worker itself
+  SUBCASE("Local") {
+
+    tf::WorkStealingThreadpool<PriorityClosure> tp(1);
+
+    std::vector<tf::TaskPriority> order;
+    std::atomic<size_t> counter {0};
+
+    tp.emplace(tf::TaskPriority::NORMAL, [&] () {
+      for(auto l : levels) {
+        tp.emplace(l, [&, l] () {
+          order.push_back(l);
+          counter++;
+        });
+      }
+    });
+
+    while(counter != levels.size()) std::this_thread::yield();
+
+    REQUIRE(is_ordered(order));
+  }
+
+  // closures of other levels arriving after the workers have served only
+  // normal ones, while the only worker is busy or all workers are idle
+  SUBCASE("Late") {
+
+    tf::WorkStealingThreadpool<PriorityClosure> tp(1);
+
+    std::mutex mutex;
+    std::vector<tf::TaskPriority> order;
+    std::atomic<bool> started {false}, release {false};
+    std::atomic<size_t> counter {0};
+
+    for(size_t i=0; i<100; ++i) {
+      tp.emplace(tf::TaskPriority::NORMAL, [&] () { counter++; });
+    }
+    while(counter != 100) std::this_thread::yield();
+
+    counter = 0;
+
+    tp.emplace(tf::TaskPriority::NORMAL, [&] () {
+      started = true;
+      while(!release) std::this_thread::sleep_for(1ms);
+    });
+
+    while(!started) std::this_thread::yield();
+
+    std::vector<PriorityClosure> closures;
+    for(auto l : levels) {
+      closures.emplace_back(l, [&, l] () {
+        std::scoped_lock lock(mutex);
+        order.push_back(l);
+        counter++;
+      });
+    }
+    tp.batch(closures);
+
+    release = true;
+    while(counter != levels.size()) std::this_thread::yield();
+
+    REQUIRE(is_ordered(order));
+
+    for(unsigned W=1; W<=4; ++W) {
+      tf::WorkStealingThreadpool<PriorityClosure> pool(W);
+      std::atomic<size_t> count {0};
+      pool.emplace(tf::TaskPriority::NORMAL, [&] () { count++; });
+      while(count != 1) std::this_thread::yield();
+      std::this_thread::sleep_for(10ms);
+      pool.emplace(tf::TaskPriority::HIGH, [&] () {
+        pool.emplace(tf::TaskPriority::LOW, [&] () { count++; });
+        count++;
+      });
+      while(count != 3) std::this_thread::yield();
+    }
+  }
+
+  for(unsigned W=0; W<=4; ++W) {
+    tf::WorkStealingThreadpool<PriorityClosure> tp(W);
+    std::atomic<size_t> counter {0};
+    std::vector<PriorityClosure> closures;
+    for(size_t i=0; i<1000; ++i) {
+      auto l = levels[i % levels.size()];
+      tp.emplace(l, [&] () { counter++; });
+      closures.emplace_back(l, [&] () { counter++; });
+    }
+    tp.batch(closures);
+    while(counter != 2000) std::this_thread::yield();
+  }
+}
+
+// ----------------------------------------------------------------------------
+// Testcase: IdlePolicy
+// ----------------------------------------------------------------------------
+TEST_CASE("IdlePolicy" * doctest::timeout(300)) {
+  
+  using Threadpool = tf::WorkStealingThreadpool<std::function<void()>>;
+
+  SUBCASE("Adaptation") {
+    auto policy = tf::IdlePolicy().spin_budget(4, 64);
+    REQUIRE(policy.min_spins() == 4);
+    REQUIRE(policy.max_spins() == 64);
+    REQUIRE(policy.adapt(64, true) == 64);
+    REQUIRE(policy.adapt(64, false) == 32);
+    REQUIRE(policy.adapt(5, false) == 4);
+    REQUIRE(policy.adapt(4, true) == 8);
+    REQUIRE(policy.adaptive(false).adapt(4, false) == 64);
+    REQUIRE(tf::IdlePolicy().spin_budget(0, 4).adapt(0, true) == 2);
+    REQUIRE(tf::IdlePolicy().spin_budget(8, 4).min_spins() == 4);
+    REQUIRE(tf::IdlePolicy().max_pause(0).max_pause() == 1);
+  }
+
+  SUBCASE("NoSpinner") {
+    for(unsigned W=0; W<=4; ++W) {
+      Threadpool tp(W, tf::CpuAffinity(), tf::IdlePolicy().max_spinners(0));
+      REQUIRE(tp.idle_policy().max_spinners() == 0);
+      test_dynamic_tasking(tp);
+      test_external_threads(tp);
+      auto stats = tp.idle_stats();
+      REQUIRE(stats.num_spins == 0);
+      REQUIRE(stats.num_yields == 0);
+      REQUIRE(stats.num_idle_steals == 0);
+    }
+  }
+
+  SUBCASE("Counters") {
+    Threadpool tp(2, tf::CpuAffinity(), tf::IdlePolicy().spin_budget(16, 16).yield_rounds(4));
+    test_dynamic_tasking(tp);
+    // idle workers go to sleep once their spin and yield budgets run out
+    while(tp.idle_stats().num_sleeps == 0) {
+      std::this_thread::yield();
+    }
+    auto stats = tp.idle_stats();
+    REQUIRE(stats.num_idle_steals <= stats.num_spins + stats.num_yields);
+    REQUIRE(stats.num_sleeps > 0);
+  }
+
+  for(auto policy : {
+    tf::IdlePolicy(), 
+    tf::IdlePolicy::latency(), 
+    tf::IdlePolicy::power_saving(),
+    tf::IdlePolicy().spin_budget(0, 0).yield_rounds(0),
+    tf::IdlePolicy().max_spinners(8).adaptive(false)
+  }) {
+    for(unsigned W=0; W<=4; ++W) {
+      Threadpool tp(W, tf::CpuAffinity(), policy);
+      test_dynamic_tasking(tp);
+      test_external_threads(tp);
+      test_batch_insertion(tp);
+    }
+  }
+}
+
+// ----------------------------------------------------------------------------
+// Testcase: ElasticThreadpool
+// ----------------------------------------------------------------------------
+TEST_CASE("ElasticThreadpool" * doctest::timeout(300)) {
+
+  using Threadpool = tf::WorkStealingThreadpool<std::function<void()>>;
+
+  SUBCASE("Resize") {
+    Threadpool tp(4);
+    REQUIRE(tp.max_workers() == 4);
+    for(size_t N : {2, 0, 4, 1, 3, 8, 0, 1}) {
+      tp.resize(N);
+      REQUIRE(tp.num_workers() == std::min(N, size_t{4}));
+      test_dynamic_tasking(tp);
+      test_external_threads(tp);
+      test_batch_insertion(tp);
+    }
+  }
+
+  // closures pending in the executor run before the last worker leaves
+  SUBCASE("Drain") {
+    Threadpool tp(2);
+    std::atomic<size_t> count {0};
+    for(int i=0; i<10; ++i) {
+      for(int j=0; j<1000; ++j) {
+        tp.emplace([&] () { count++; });
+      }
+      tp.resize(i % 2 ? 2 : 0);
+    }
+    tp.resize(2);
+    while(count != 10000);
+  }
+
+  // closures pushed by external threads while the last worker leaves still 
+  // run, inline if no worker is left
+  SUBCASE("ConcurrentDrain") {
+    Threadpool tp(2);
+    std::atomic<size_t> count {0};
+    std::atomic<bool> done {false};
+    std::vector<std::thread> producers;
+    for(int p=0; p<2; ++p) {
+      producers.emplace_back([&] () {
+        for(int j=0; j<20000; ++j) {
+          tp.emplace([&] () { count++; });
+        }
+      });
+    }
+    std::thread resizer([&] () {
+      for(int i=0; !done; ++i) {
+        tp.resize(i % 2 ? 2 : 0);
+      }
+    });
+    for(auto& t : producers) {
+      t.join();
+    }
+    done = true;
+    resizer.join();
+    tp.resize(0);
+    REQUIRE(count == 40000);
+  }
+
+  SUBCASE("Elastic") {
+    Threadpool tp(4);
+    tp.elastic(1, std::chrono::milliseconds(1));
+    REQUIRE(tp.elastic());
+    
+    // idle workers retire down to the minimum
+    while(tp.num_workers() != 1) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+   
+    for(int i=0; i<3; ++i) {
+      test_external_threads(tp);
+      test_batch_insertion(tp);
+      REQUIRE(tp.num_workers() >= 1);
+      REQUIRE(tp.num_workers() <= 4);
+    }
+
+    tp.resize(3);
+    REQUIRE(!tp.elastic());
+    REQUIRE(tp.num_workers() == 3);
+    test_dynamic_tasking(tp);
+  }
+}
@@ -5,6 +5,9 @@
 #include <taskflow/utility/traits.hpp>
 #include <taskflow/utility/passive_vector.hpp>
 #include <taskflow/utility/singular_allocator.hpp>
+#include <taskflow/utility/unique_function.hpp>
+#include <array>
+#include <memory>
 
 // --------------------------------------------------------
 // Testcase: PassiveVector
@@ -219,3 +222,67 @@ TEST_CASE("SingularAllocator" * doctest::timeout(300)) {
 
 
 
+
+// --------------------------------------------------------
+// Testcase: UniqueFunction
+// --------------------------------------------------------
+TEST_CASE("UniqueFunction" * doctest::timeout(300)) {
+
+  using Function = tf::UniqueFunction<int(int), 32>;
+
+  SUBCASE("Empty") {
+    Function f;
+    REQUIRE(f == nullptr);
+    REQUIRE(!f);
+    REQUIRE_THROWS_AS(f(1), std::bad_function_call);
+    f = [] (int i) { return i; };
+    REQUIRE(f != nullptr);
+    f = nullptr;
+    REQUIRE(f == nullptr);
+  }
+
+  SUBCASE("Inline") {
+    int base = 10;
+    auto small = [&base] (int i) { return base + i; };
+    REQUIRE(Function::stores_inline<decltype(small)>());
+    Function f {small};
+    REQUIRE(f(1) == 11);
+    Function g {std::move(f)};
+    REQUIRE(f == nullptr);
+    REQUIRE(g(2) == 12);
+  }
+
+  SUBCASE("Heap") {
+    std::array<int, 64> data;
+    data.fill(1);
+    auto large = [data] (int i) { return data[0] + data[63] + i; };
+    REQUIRE(!Function::stores_inline<decltype(large)>());
+    Function f {large};
+    Function g;
+    g = std::move(f);
+    REQUIRE(f == nullptr);
+    REQUIRE(g(1) == 3);
+  }
+
+  SUBCASE("MoveOnly") {
+    auto counter = std::make_shared<int>(0);
+    {
+      Function f {[p=std::make_unique<int>(5), c=counter] (int i) mutable { 
+        ++(*c); 
+        return *p + i; 
+      }};
+      REQUIRE(counter.use_count() == 2);
+      REQUIRE(f(1) == 6);
+      std::vector<Function> fs;
+      for(int i=0; i<100; ++i) {
+        fs.push_back(std::move(f));
+        f = std::move(fs.back());
+        fs.pop_back();
+      }
+      REQUIRE(f(2) == 7);
+      REQUIRE(*counter == 2);
+      REQUIRE(counter.use_count() == 2);
+    }
+    REQUIRE(counter.use_count() == 1);
+  }
+}